@@ -1,579 +0,0 @@
-#include "MainWindow.h"
-#include "qscrollbar.h"
-#include "qtextobject.h"
-#include "ui_MainWindow.h"
-#include <QDebug>
-#include <QMenu>
-#include <QFileDialog>
-#include <QMessageBox>
-#include <QTextDocumentFragment>
-#include "SettingsWindow.h"
-#include "Settings.h"
-#include "Document.h"
-#include <QTimer>
-#include <QShortcut>
-#include "FileManager.h"
-
-MainWindow::MainWindow(QWidget *parent)
-    : QMainWindow(parent)
-    , ui(new Ui::MainWindow)
-    , rootDocument(nullptr)
-    , mPreFilterTopBlock(0)
-{
-    ui->setupUi(this);
-
-    // Pre-load icons once. Previously a new QIcon was constructed from the
-    // resource path inside updateSaveAndMenuButtonIcons() on every call,
-    // which fired on every keystroke via on_plainTextEdit_textChanged.
-    mIconMenuClean   = QIcon(":/resources/128x128/menu.png");
-    mIconMenuChanged = QIcon(":/resources/128x128/menu_changed.png");
-    mIconSaveClean   = QIcon(":/resources/128x128/save.png");
-    mIconSaveChanged = QIcon(":/resources/128x128/save_changed.png");
-
-    // Hide menu panel
-    on_pushButtonMenu_clicked(false);
-
-    ui->frameInfo->setVisible(false);
-
-    // Set position
-    restoreGeometry(Settings::getInstance().getWindowGeometry());
-
-    applySettings();
-    loadLastFile();
-
-    ui->lineEditSearch->installEventFilter(this);
-
-    // Wire the built-in X (clear) button inside lineEditSearch to our slot.
-    // clearButtonEnabled is set in the .ui, so the action already exists here.
-    auto* clearAction = ui->lineEditSearch->findChild<QAction*>();
-    if (clearAction)
-    {
-        connect(clearAction,
-                &QAction::triggered,
-                this,
-                &MainWindow::clearFilter);
-    }
-
-    // Ctrl+F shortcut — focuses and clears the filter field.
-    auto* ctrlF = new QShortcut(QKeySequence(Qt::CTRL | Qt::Key_F), this);
-    connect(ctrlF,
-            &QShortcut::activated,
-            this,
-            &MainWindow::clearFilter);
-}
-
-MainWindow::~MainWindow()
-{
-    delete ui;
-}
-
-void MainWindow::applySettings()
-{
-    ui->plainTextEdit->setFont(Settings::getInstance().getFont());
-    ui->plainTextEdit->updateTabWidth();
-    setAlwaysOnTop();
-    setWordWrap();
-    setRecentFiles();
-}
-
-void MainWindow::closeEvent(QCloseEvent *event)
-{
-    Settings::getInstance().setWindowGeometry(saveGeometry());
-    if (ui->plainTextEdit->isDirty())
-    {
-        QMessageBox::StandardButton reply =
-            QMessageBox::question(
-                this,
-                "Text Filter",
-                "Save before quit?",
-                QMessageBox::Yes|QMessageBox::No|QMessageBox::Cancel);
-
-        if (reply == QMessageBox::Yes)
-        {
-            QString filename = Settings::getInstance().getFilename();
-            saveFile(filename);
-        }
-        else if (reply == QMessageBox::Cancel)
-        {
-            event->ignore();
-            return;
-        }
-    }
-
-    // Settings::setXxx() only schedules a debounced write (fires ~400ms
-    // later via mSaveTimer). The application can exit before that timer
-    // ever runs, silently dropping every setting changed in this session —
-    // including the saveGeometry() call right above. flushNow() cancels the
-    // pending timer and writes immediately, guaranteeing the final state
-    // reaches disk before the process exits.
-    Settings::getInstance().flushNow();
-}
-
-void MainWindow::undoToHistoryPoint(int historyPoint)
-{
-
-    while (ui->plainTextEdit->document()->availableUndoSteps() > historyPoint)
-    {
-        ui->plainTextEdit->document()->undo();
-    }
-}
-
-void MainWindow::on_lineEditSearch_textChanged(const QString &filter)
-{
-    if (filter.isEmpty())
-    {
-        if (rootDocument != nullptr)
-        {
-            undoToHistoryPoint(rootDocument->getUndoHistoryPoint());
-            rootDocument.reset();
-
-            // Defer scroll restore: undo triggers layout/range updates that
-            // Qt processes after this slot returns, which would override setValue.
-            // singleShot(0) fires after those pending events are processed.
-            QTimer::singleShot(0, this, &MainWindow::restoreScrollPosition);
-        }
-    }
-    else
-    {
-        if (rootDocument == nullptr)
-        {
-            rootDocument.reset(new Document(ui->plainTextEdit->document()));
-        }
-
-        if (filter.length() >= Settings::getInstance().getFilterThreshold())
-        {
-            rootDocument->applyFilter(filter);
-            auto filteredDocument = rootDocument->getFilteredDocument();
-            ui->plainTextEdit->setTextFromOtherDocument(filteredDocument);
-        }
-    }
-
-    bool isTextFiltered = rootDocument && rootDocument->getFilteredLineCount() > 0;
-    ui->toolButtonPrevious->setEnabled(isTextFiltered);
-    ui->toolButtonNext->setEnabled(isTextFiltered);
-}
-
-void MainWindow::loadLastFile()
-{
-    QString filename = Settings::getInstance().getFilename();
-
-    ui->plainTextEdit->setPlainText(FileManager::load(filename));
-
-    ui->lineEditSearch->clear();
-    ui->toolButtonPrevious->setEnabled(false);
-    ui->toolButtonNext->setEnabled(false);
-    setWindowTitle(filename + (filename.isEmpty() ? "" : " - ") + "Text Filter");
-    updateSaveAndMenuButtonIcons();
-}
-
-void MainWindow::setAlwaysOnTop()
-{
-    Qt::WindowFlags flags = this->windowFlags();
-    if (Settings::getInstance().isAlwaysOnTop())
-    {
-        flags = flags | Qt::WindowStaysOnTopHint;
-    }
-    else
-    {
-        flags = flags & ~Qt::WindowStaysOnTopHint;
-    }
-    this->setWindowFlags(flags);
-    this->show();
-
-    ui->toolButtonAlwaysOnTop->setChecked(
-        Settings::getInstance().isAlwaysOnTop());
-}
-
-void MainWindow::setWordWrap()
-{
-    QPlainTextEdit::LineWrapMode mode =
-        Settings::getInstance().isWordWrap()
-            ? QPlainTextEdit::WidgetWidth
-            : QPlainTextEdit::NoWrap;
-
-    ui->plainTextEdit->setLineWrapMode(mode);
-    ui->toolButtonWordWrap->setChecked(Settings::getInstance().isWordWrap());
-}
-
-void MainWindow::loadFile(const QString &filename)
-{
-    if (filename.isEmpty())
-    {
-        return;
-    }
-
-    if (ui->plainTextEdit->isDirty())
-    {
-        QMessageBox::StandardButton reply =
-            QMessageBox::question(
-                this,
-                "Text Filter",
-                "Save changed file?",
-                QMessageBox::Yes|QMessageBox::No|QMessageBox::Cancel);
-
-        if (reply == QMessageBox::Yes)
-        {
-            QString oldFile = Settings::getInstance().getFilename();
-            saveFile(oldFile);
-        }
-        else if (reply == QMessageBox::Cancel)
-        {
-            return;
-        }
-    }
-
-    ui->lineEditSearch->clear();
-    ui->plainTextEdit->setPlainText(FileManager::load(filename));
-    updateFilename(filename);
-    updateSaveAndMenuButtonIcons();
-}
-
-void MainWindow::saveFile(const QString& filename)
-{
-    ui->lineEditSearch->clear();
-
-    if (filename.isEmpty())
-    {
-        on_toolButtonSaveFileAs_clicked();
-        return;
-    }
-
-    try
-    {
-        FileManager::save(filename, ui->plainTextEdit->toPlainText());
-        ui->plainTextEdit->setDirty(false);
-        ui->plainTextEdit->document()->setModified(false);
-        Settings::getInstance().setFilename(filename);
-        updateFilename(filename);
-        on_pushButtonMenu_clicked(false);
-        ui->frameInfo->setVisible(true);
-        QTimer::singleShot(2000, this, SLOT(hideFrameInfo()));
-    }
-    catch(const std::runtime_error& ex)
-    {
-        QMessageBox::information(this, tr("Unable to save file"), ex.what());
-    }
-}
-
-void MainWindow::updateFilename(const QString &filename)
-{
-    Settings::getInstance().setFilename(filename);
-    Settings::getInstance().addRecentFile(filename);
-    setRecentFiles();
-    setWindowTitle(filename + " - Text Filter");
-    updateSaveAndMenuButtonIcons();
-}
-
-void MainWindow::hideFrameInfo()
-{
-    ui->frameInfo->setVisible(false);
-}
-
-void MainWindow::restoreScrollPosition()
-{
-    QTimer::singleShot(0, this, &MainWindow::applyRestoredScrollPosition);
-}
-
-void MainWindow::applyRestoredScrollPosition()
-{
-    // QPlainTextEdit's vertical scrollbar counts visual rows (wrapped lines),
-    // not blocks. documentLayout()->blockBoundingRect() returns zeros until
-    // blocks are painted, so we count visual rows by walking blocks directly.
-    int visualRow = 0;
-    QTextBlock block = ui->plainTextEdit->document()->begin();
-    while (block.isValid() && block.blockNumber() < mPreFilterTopBlock)
-    {
-        // lineCount() returns the number of visual rows this block occupies
-        // (> 1 when word wrap is on and the line is long)
-        visualRow += qMax(1, block.lineCount());
-        block = block.next();
-    }
-
-    ui->plainTextEdit->verticalScrollBar()->setValue(visualRow);
-    ui->plainTextEdit->horizontalScrollBar()->setValue(0);
-}
-
-void MainWindow::on_toolButtonPrevious_clicked()
-{
-    if (rootDocument == nullptr)
-    {
-        return;
-    }
-
-    ui->plainTextEdit->setTextFromOtherDocument(
-        rootDocument->getFullDocumentWithPrevLineHighlighted());
-
-    int lineNum = rootDocument->getCurrentHighlightedLineNum();
-    QTextBlock block = ui->plainTextEdit->document()->findBlockByNumber(lineNum);
-    if (block.isValid())
-    {
-        QTextCursor cursor(block);
-        ui->plainTextEdit->setTextCursor(cursor);
-        ui->plainTextEdit->centerCursor();
-    }
-}
-
-void MainWindow::on_toolButtonNext_clicked()
-{
-    if (rootDocument == nullptr)
-    {
-        return;
-    }
-
-    ui->plainTextEdit->setTextFromOtherDocument(
-        rootDocument->getFullDocumentWithNextLineHighlighted());
-
-    int lineNum = rootDocument->getCurrentHighlightedLineNum();
-    QTextBlock block = ui->plainTextEdit->document()->findBlockByNumber(lineNum);
-    if (block.isValid())
-    {
-        QTextCursor cursor(block);
-        ui->plainTextEdit->setTextCursor(cursor);
-        ui->plainTextEdit->centerCursor();
-    }
-}
-
-void MainWindow::on_toolButtonOpenFile_clicked()
-{
-    QString filename =
-        QFileDialog::getOpenFileName(
-            this,
-            tr("Open File"), "",
-            tr("Text File (*.txt);;All Files (*)"));
-
-    loadFile(filename);
-}
-
-void MainWindow::on_toolButtonSaveFile_clicked()
-{
-    QString filename = Settings::getInstance().getFilename();
-    saveFile(filename);
-}
-
-void MainWindow::on_toolButtonSaveFileAs_clicked()
-{
-    QString filename =
-        QFileDialog::getSaveFileName(
-            this,
-            tr("Save File"), "",
-            tr("Text File (*.txt);;All Files (*)"));
-
-    if (!filename.isEmpty())
-    {
-        saveFile(filename);
-    }
-}
-
-void MainWindow::clearFilter()
-{
-    // Save the top visible block number before clear() triggers textChanged("")
-    // which calls undoToHistoryPoint and changes the document.
-    // Block numbers are stable across filtered/unfiltered views unlike scrollbar values.
-    mPreFilterTopBlock = ui->plainTextEdit->firstVisibleBlock().blockNumber();
-    ui->lineEditSearch->clear();
-    ui->lineEditSearch->setFocus();
-}
-
-void MainWindow::on_toolButtonCopyLine_clicked()
-{
-    QTextCursor cursor(ui->plainTextEdit->textCursor());
-    cursor.movePosition(QTextCursor::EndOfBlock);
-    cursor.movePosition(QTextCursor::StartOfBlock, QTextCursor::KeepAnchor);
-    ui->plainTextEdit->setTextCursor(cursor);
-    ui->plainTextEdit->copy();
-}
-
-void MainWindow::on_toolButtonCopyMultipleLines_clicked()
-{
-    QTextCursor cursor = ui->plainTextEdit->textCursor();
-    if (cursor.hasSelection())
-    {
-        int start = cursor.selectionStart();
-        int end = cursor.selectionEnd();
-
-        // Check if selection begins from beginning of line
-        cursor.setPosition(start);
-        cursor.movePosition(QTextCursor::StartOfLine);
-        if (start == cursor.position())
-        {
-            // Continue selecting text
-            cursor.setPosition(end, QTextCursor::KeepAnchor);
-            cursor.movePosition(QTextCursor::Down, QTextCursor::KeepAnchor);
-            cursor.movePosition(QTextCursor::StartOfLine, QTextCursor::KeepAnchor);
-            ui->plainTextEdit->setTextCursor(cursor);
-            ui->plainTextEdit->copy();
-            return;
-        }
-        else
-        {
-            // If selections begins in the middle of the line
-            // ignore selection and copy current line
-            cursor.setPosition(end);
-        }
-    }
-
-    cursor.movePosition(QTextCursor::StartOfLine);
-    cursor.movePosition(QTextCursor::Down, QTextCursor::KeepAnchor);
-    cursor.movePosition(QTextCursor::StartOfLine, QTextCursor::KeepAnchor);
-    ui->plainTextEdit->setTextCursor(cursor);
-    ui->plainTextEdit->copy();
-}
-
-void MainWindow::on_toolButtonAlwaysOnTop_clicked()
-{
-    Settings::getInstance().setAlwaysOnTop(!Settings::getInstance().isAlwaysOnTop());
-    setAlwaysOnTop();
-}
-
-void MainWindow::on_toolButtonSettings_clicked()
-{
-    SettingsWindow settingsWindow;
-    settingsWindow.setModal(true);
-
-    connect(&settingsWindow, &SettingsWindow::applySettings,
-            this, &MainWindow::applySettings);
-
-    Qt::WindowFlags flags = settingsWindow.windowFlags();
-    flags = flags & ~Qt::WindowContextHelpButtonHint; // Hide help ? button
-    if (Settings::getInstance().isAlwaysOnTop())
-    {
-        flags = flags | Qt::WindowStaysOnTopHint;
-    }
-    else
-    {
-        flags = flags & ~Qt::WindowStaysOnTopHint;
-    }
-    settingsWindow.setWindowFlags(flags);
-    settingsWindow.exec();
-}
-
-void MainWindow::on_toolButtonHelp_clicked()
-{
-    QMessageBox::information(
-        this,
-        tr("Text Filter"),
-        tr("Text Filter v1.7\n"
-           "\n"
-           " * Use fuzzy match to filter text (e.g. 'ore psu' will find 'Lorem Ipsum').\n"
-           " * Press Enter in the Filter field to go to the next filter result.\n"
-           " * Use Ctrl+Left Mouse Click on the line, to copy whole line to clipboard.\n"
-           " * Press Alt+C several times to extend selection and copy multiple lines to clipboard.\n"
-           "\n"
-           "Icons are taken from sites:\n"
-           "- http://www.iconarchive.com\n"
-           "- http://www.iconsmind.com\n"
-           "- http://icons8.com\n"
-           "\n"
-           "Written by Stepan Sypliak using Qt Creator."),
-        QMessageBox::Ok);
-}
-
-void MainWindow::on_toolButtonWordWrap_clicked()
-{
-    Settings::getInstance().setWordWrap(!Settings::getInstance().isWordWrap());
-    setWordWrap();
-}
-
-void MainWindow::on_pushButtonMenu_clicked(bool checked)
-{
-    // Shortcuts does not work when control is not visible
-    ui->widgetMenu->setMinimumSize(0, checked ? 40 : 0);
-    ui->widgetMenu->setMaximumSize(16777215, checked ? 40 : 0);
-    ui->pushButtonMenu->setChecked(checked);
-}
-
-void MainWindow::on_toolButtonNewFile_clicked()
-{
-    ui->plainTextEdit->clear();
-    ui->lineEditSearch->clear();
-    Settings::getInstance().setFilename("");
-    setWindowTitle("Untitled - Text Filter");
-}
-
-void MainWindow::on_plainTextEdit_textChanged()
-{
-    if (rootDocument == nullptr)
-    {
-        ui->plainTextEdit->setDirty(ui->plainTextEdit->document()->isModified());
-    }
-    else
-    {
-        ui->plainTextEdit->setDirty(rootDocument->getDocument()->isModified());
-    }
-    updateSaveAndMenuButtonIcons();
-}
-
-void MainWindow::setRecentFiles()
-{
-    for (auto* action : ui->toolButtonOpenFile->actions())
-    {
-        ui->toolButtonOpenFile->removeAction(action);
-        delete action;
-    }
-
-    const QStringList recentFiles = Settings::getInstance().getRecentFiles();
-    for (const QString& filename : recentFiles)
-    {
-        QAction* recentFile = new QAction(filename, this);
-        QObject::connect(recentFile, SIGNAL(triggered()), this, SLOT(openRecent()));
-        ui->toolButtonOpenFile->addAction(recentFile);
-    }
-}
-
-void MainWindow::openRecent()
-{
-    QAction* action = qobject_cast<QAction *>(sender());
-    loadFile(action->text());
-}
-
-void MainWindow::updateSaveAndMenuButtonIcons()
-{
-    const bool dirty = ui->plainTextEdit->isDirty();
-
-    // Guard: skip entirely if the dirty state hasn't changed since the last
-    // call. This is what prevents setIcon() (and previously, QIcon
-    // construction) from running on every single keystroke — only the
-    // keystroke that actually flips clean<->dirty does any work.
-    const int dirtyState = dirty ? 1 : 0;
-    if (dirtyState == mLastDirtyState)
-    {
-        return;
-    }
-    mLastDirtyState = dirtyState;
-
-    ui->pushButtonMenu->setIcon    (dirty ? mIconMenuChanged : mIconMenuClean);
-    ui->toolButtonSaveFile->setIcon(dirty ? mIconSaveChanged : mIconSaveClean);
-}
-
-void MainWindow::setIconMultipleResolutions(QAbstractButton *button, const QString& iconName)
-{
-    QIcon icon(":/resources/128x128/" + iconName);
-    button->setIcon(icon);
-}
-
-bool MainWindow::eventFilter(QObject *obj, QEvent *event)
-{
-    if (obj == ui->lineEditSearch && event->type() == QEvent::KeyPress)
-    {
-        QKeyEvent *keyEvent = static_cast<QKeyEvent*>(event);
-        if (keyEvent->key() == Qt::Key_Escape)
-        {
-            clearFilter();
-            return true; // Mark event as handled (intercepted)
-        }
-        else if (keyEvent->key() == Qt::Key_Return || keyEvent->key() == Qt::Key_Enter)
-        {
-            if (keyEvent->modifiers() & Qt::ShiftModifier)
-            {
-                on_toolButtonPrevious_clicked();
-            }
-            else
-            {
-                on_toolButtonNext_clicked();
-            }
-            return true;
-        }
-    }
-    // Pass unhandled events to the parent class hierarchy
-    return QMainWindow::eventFilter(obj, event);
-}
\ No newline at end of file
@@ -0,0 +1,465 @@
+#include "FilterCommand.h"
+#include "Document.h"
+#include "MappedFile.h"
+#include "TextCodec.h"
+
+#include <QCommandLineParser>
+#include <QFile>
+#include <QFileInfo>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <optional>
+
+#ifdef Q_OS_WIN
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+// Input is filtered this many bytes at a time, plus the rest of a line
+constexpr qsizetype kBlockBytes = 8 * 1024 * 1024;
+
+// Encoding is guessed from at most this many bytes of the first read
+constexpr qsizetype kDetectBytes = 64 * 1024;
+
+// Same as grep --color
+const QString kHighlightBegin = QStringLiteral("\x1b[01;31m");
+const QString kHighlightEnd = QStringLiteral("\x1b[0m");
+
+// Unlike QFile::read, returns what a pipe has so far instead of
+// waiting for all of maxSize, so piped input is filtered as it comes
+qint64 readSome(int fd, char* data, qint64 maxSize)
+{
+#ifdef Q_OS_WIN
+    return _read(fd, data, unsigned(std::min<qint64>(maxSize, INT_MAX)));
+#else
+    qint64 n = 0;
+    do
+    {
+        n = ::read(fd, data, size_t(maxSize));
+    }
+    while (n < 0 && errno == EINTR);
+    return n;
+#endif
+}
+
+struct InputBlock
+{
+    // Decoded lines, they are printed as they are
+    QString text;
+    std::vector<qsizetype> lineStarts;
+
+    // Folded copy of the lines, which is filtered
+    TextBuffer foldedText;
+
+    // Number of the first line of the block in the whole input
+    qint64 firstLineNum = 0;
+
+    QStringView line(int lineNum) const
+    {
+        const qsizetype start = lineStarts[lineNum];
+        return QStringView(text).mid(start, lineStarts[lineNum + 1] - start - 1);
+    }
+};
+
+// Block of the lines of text, which are joined with \n
+InputBlock inputBlock(QString text, qint64 firstLineNum)
+{
+    InputBlock block;
+    block.firstLineNum = firstLineNum;
+    const int lineCount = static_cast<int>(text.count(u'\n')) + 1;
+    block.lineStarts.reserve(lineCount + 1);
+    block.lineStarts.push_back(0);
+    for (QStringView line : QStringView(text).split(u'\n'))
+    {
+        block.foldedText.appendLine(line);
+
+        // Every line is followed by a line break, but the last one
+        block.lineStarts.push_back(block.lineStarts.back() + line.size() + 1);
+    }
+    block.text = std::move(text);
+    return block;
+}
+
+// Splits input into blocks of whole lines
+class InputReader
+{
+public:
+
+    explicit InputReader(int fd)
+        : mFd(fd)
+        , mIsDetected(false)
+        , mAtEnd(false)
+        , mEncoding(TextCodec::Encoding::Utf8)
+        , mNextLineNum(0)
+    {
+    }
+
+    // Next block of lines, nothing at the end of input
+    std::optional<InputBlock> next();
+
+    QString errorString() const { return mErrorString; }
+
+private:
+
+    void readMore(QByteArray& bytes);
+    void detectEncoding(QByteArray& bytes);
+
+    int mFd;
+    bool mIsDetected;
+    bool mAtEnd;
+    TextCodec::Encoding mEncoding;
+    qint64 mNextLineNum;
+
+    // Beginning of a line which did not fit into the previous block
+    QByteArray mPending;
+
+    QString mErrorString;
+};
+
+std::optional<InputBlock> InputReader::next()
+{
+    QByteArray bytes = std::move(mPending);
+    mPending = QByteArray();
+
+    qsizetype lineEnd = 0;
+    while (!mAtEnd && lineEnd == 0)
+    {
+        readMore(bytes);
+        if (!mIsDetected && !bytes.isEmpty())
+        {
+            detectEncoding(bytes);
+        }
+        lineEnd = TextCodec::lastLineEnd(bytes, mEncoding);
+    }
+
+    // Last line of the input needs no line break
+    if (!mAtEnd)
+    {
+        mPending = bytes.mid(lineEnd);
+        bytes.truncate(lineEnd);
+    }
+    if (bytes.isEmpty())
+    {
+        return std::nullopt;
+    }
+
+    QString text = TextCodec::decode(bytes, mEncoding);
+
+    // Final line break ends the last line, it does not start another one
+    if (text.endsWith(u'\n') || (mAtEnd && text.endsWith(u'\r')))
+    {
+        text.chop(1);
+    }
+
+    InputBlock block = inputBlock(std::move(text), mNextLineNum);
+    mNextLineNum += block.foldedText.lineCount();
+    return block;
+}
+
+void InputReader::readMore(QByteArray& bytes)
+{
+    const qsizetype target = bytes.size() + kBlockBytes;
+    while (bytes.size() < target)
+    {
+        const qsizetype size = bytes.size();
+        bytes.resize(target);
+        const qint64 n = readSome(mFd, bytes.data() + size, target - size);
+        bytes.resize(size + std::max<qint64>(n, 0));
+
+        if (n <= 0)
+        {
+            if (n < 0)
+            {
+                mErrorString = QString::fromLocal8Bit(std::strerror(errno));
+            }
+            mAtEnd = true;
+            return;
+        }
+
+        // Pipe has nothing more for now
+        if (n < target - size)
+        {
+            return;
+        }
+    }
+}
+
+void InputReader::detectEncoding(QByteArray& bytes)
+{
+    int bomLength = 0;
+    mEncoding = TextCodec::detect(
+        QByteArrayView(bytes).left(std::min(bytes.size(), kDetectBytes)),
+        bomLength);
+    bytes.remove(0, bomLength);
+    mIsDetected = true;
+}
+
+// Splits a regular file into blocks of whole lines. The file is
+// mapped, and only the block which is filtered next is decoded.
+class MappedReader
+{
+public:
+
+    explicit MappedReader(const MappedFile& file);
+
+    std::optional<InputBlock> next();
+
+    QString errorString() const { return mErrorString; }
+
+private:
+
+    const MappedFile& mFile;
+    int mLineCount;
+    int mNextLineNum;
+    QString mErrorString;
+};
+
+MappedReader::MappedReader(const MappedFile& file)
+    : mFile(file)
+    , mLineCount(file.lineCount())
+    , mNextLineNum(0)
+{
+    // Final line break ends the last line, it does not start another one
+    if (mLineCount > 0 && mFile.lineBytes(mLineCount - 1).isEmpty())
+    {
+        --mLineCount;
+    }
+}
+
+std::optional<InputBlock> MappedReader::next()
+{
+    if (mNextLineNum >= mLineCount)
+    {
+        return std::nullopt;
+    }
+
+    // Its mapped bytes past the new end cannot be read
+    if (mFile.isTruncated())
+    {
+        mErrorString = QStringLiteral("file truncated");
+        return std::nullopt;
+    }
+
+    const int firstLine = mNextLineNum;
+    qint64 bytes = 0;
+    do
+    {
+        bytes += mFile.lineBytes(mNextLineNum).size() + 1;
+        ++mNextLineNum;
+    }
+    while (mNextLineNum < mLineCount && bytes < kBlockBytes);
+
+    return inputBlock(mFile.text(firstLine, mNextLineNum - firstLine), firstLine);
+}
+
+struct Options
+{
+    QString filter;
+    bool isLineNumber = false;
+    bool isHighlight = false;
+    bool isFilenamePrefix = false;
+};
+
+bool writeOutput(const QString& text)
+{
+    const QByteArray bytes = TextCodec::encodeUtf8(text);
+    return std::fwrite(bytes.constData(), 1, bytes.size(), stdout) == size_t(bytes.size())
+        && std::fflush(stdout) == 0;
+}
+
+QString formatMatches(
+    const InputBlock& block,
+    const MatchList& matches,
+    const QString& prefix,
+    const Options& options)
+{
+    QString out;
+    for (int n = 0; n < matches.size(); ++n)
+    {
+        const int lineNum = matches.lineAt(n);
+        const QStringView line = block.line(lineNum);
+
+        out += prefix;
+        if (options.isLineNumber)
+        {
+            out += QString::number(block.firstLineNum + lineNum + 1);
+            out += u':';
+        }
+
+        if (options.isHighlight)
+        {
+            // Areas were found in the folded line, which has the
+            // same length, so they apply to the original line too
+            int pos = 0;
+            for (const HighlightArea* area = matches.areaBegin(n); area != matches.areaEnd(n); ++area)
+            {
+                out += line.mid(pos, area->begin - pos);
+                out += kHighlightBegin;
+                out += line.mid(area->begin, area->end - area->begin);
+                out += kHighlightEnd;
+                pos = area->end;
+            }
+            out += line.mid(pos);
+        }
+        else
+        {
+            out += line;
+        }
+        out += u'\n';
+    }
+    return out;
+}
+
+// Reader is an InputReader or a MappedReader.
+// Returns false on read or write errors.
+template<typename Reader>
+bool filterInput(
+    Reader& reader,
+    const QString& name,
+    const FilterQuery& query,
+    const Options& options,
+    bool& hasMatches)
+{
+    const QString prefix = options.isFilenamePrefix ? name + u':' : QString();
+
+    // Next block is read and folded while this one is filtered
+    QFuture<std::optional<InputBlock>> pending =
+        QtConcurrent::run([&reader]() { return reader.next(); });
+
+    while (true)
+    {
+        std::optional<InputBlock> block = pending.result();
+        if (!block)
+        {
+            break;
+        }
+        pending = QtConcurrent::run([&reader]() { return reader.next(); });
+
+        MatchList matches;
+        Document::filterText(block->foldedText, query, matches);
+        if (matches.isEmpty())
+        {
+            continue;
+        }
+
+        hasMatches = true;
+        if (!writeOutput(formatMatches(*block, matches, prefix, options)))
+        {
+            pending.waitForFinished();
+            std::fprintf(stderr, "TextFilter: %s\n", std::strerror(errno));
+            return false;
+        }
+    }
+
+    if (!reader.errorString().isEmpty())
+    {
+        std::fprintf(stderr, "TextFilter: %s: %s\n",
+                     qUtf8Printable(name), qUtf8Printable(reader.errorString()));
+        return false;
+    }
+    return true;
+}
+
+}
+
+bool FilterCommand::isRequested(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--filter") == 0
+            || std::strncmp(argv[i], "--filter=", 9) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+int FilterCommand::run(const QStringList& arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Write lines matching the filter to stdout.\n"
+        "Filter items are matched in order, ignoring case, "
+        "e.g. \"ore psu\" matches \"Lorem Ipsum\".");
+    parser.addHelpOption();
+    parser.addOption({"filter", "Filter text.", "text"});
+    parser.addOption({{"n", "line-number"}, "Prefix lines with their line numbers."});
+    parser.addOption({"highlight", "Highlight matched items with terminal colors."});
+    parser.addPositionalArgument("files", "Files to filter, stdin if none or -.", "[files...]");
+    parser.process(arguments);
+
+    Options options;
+    options.filter = parser.value("filter");
+    options.isLineNumber = parser.isSet("line-number");
+    options.isHighlight = parser.isSet("highlight");
+
+    QStringList files = parser.positionalArguments();
+    if (files.isEmpty())
+    {
+        files.append("-");
+    }
+    options.isFilenamePrefix = files.size() > 1;
+
+#ifdef Q_OS_WIN
+    // UTF-16 input and \r\n must reach the decoder as they are
+    _setmode(_fileno(stdin), _O_BINARY);
+#endif
+
+    const FilterQuery query(options.filter);
+    bool hasMatches = false;
+    bool hasErrors = false;
+
+    for (const QString& name : files)
+    {
+        if (name == "-")
+        {
+            InputReader reader(fileno(stdin));
+            hasErrors |= !filterInput(reader, "(standard input)", query, options, hasMatches);
+            continue;
+        }
+
+        // Regular files are mapped, pipes and devices are read as they come
+        if (QFileInfo(name).isFile())
+        {
+            const MappedFile file(name);
+            if (!file.isOpen())
+            {
+                std::fprintf(stderr, "TextFilter: %s: %s\n",
+                             qUtf8Printable(name), qUtf8Printable(file.errorString()));
+                hasErrors = true;
+                continue;
+            }
+            MappedReader reader(file);
+            hasErrors |= !filterInput(reader, name, query, options, hasMatches);
+            continue;
+        }
+
+        QFile file(name);
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            std::fprintf(stderr, "TextFilter: %s: %s\n",
+                         qUtf8Printable(name), qUtf8Printable(file.errorString()));
+            hasErrors = true;
+            continue;
+        }
+        InputReader reader(file.handle());
+        hasErrors |= !filterInput(reader, name, query, options, hasMatches);
+    }
+
+    if (hasErrors)
+    {
+        return 2;
+    }
+    return hasMatches ? 0 : 1;
+}
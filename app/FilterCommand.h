@@ -0,0 +1,27 @@
+#ifndef FILTER_COMMAND_H
+#define FILTER_COMMAND_H
+
+#include <QStringList>
+
+// Headless mode: TextFilter --filter "ore psu" [file...]
+// Lines of the files, or of stdin without files, which match the
+// filter are written to stdout, like grep does. Matching is the same
+// as in the window, including its parallel and SSE2 scan.
+//
+// Input is filtered in blocks of whole lines, the next block is read
+// while the current one is filtered, so memory use does not grow with
+// the size of the input. Regular files are mapped and only the next
+// block is decoded, pipes are read a block at a time.
+namespace FilterCommand
+{
+
+// True if the arguments ask for the headless mode.
+// Checked before any QApplication is made, so it takes argv.
+bool isRequested(int argc, char *argv[]);
+
+// Exit code is 0 if any line matched, 1 if none did, 2 on errors
+int run(const QStringList& arguments);
+
+};
+
+#endif // FILTER_COMMAND_H
@@ -0,0 +1,631 @@
+#include "FilterView.h"
+#include "Trace.h"
+
+#include <QApplication>
+#include <QClipboard>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QScrollBar>
+#include <QSet>
+#include <QSignalBlocker>
+#include <QTextBlock>
+#include <QTextDocument>
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+// Space between line numbers and text, as in QPlainTextEdit
+constexpr int kTextMargin = 4;
+
+const QColor kGutterColor(233, 233, 233);
+const QColor kLineNumberColor(140, 140, 140);
+const QColor kSelectedRowColor(233, 233, 233);
+
+}
+
+FilterView::FilterView(QWidget *parent)
+    : QAbstractScrollArea(parent)
+    , mDocument(nullptr)
+    , mWordWrap(false)
+    , mCurrentRow(-1)
+    , mAnchorRow(-1)
+    , mMaxLineWidth(0)
+{
+    setFocusPolicy(Qt::StrongFocus);
+    viewport()->setBackgroundRole(QPalette::Base);
+    viewport()->setAutoFillBackground(true);
+    verticalScrollBar()->setSingleStep(1);
+}
+
+void FilterView::setTextDocument(const QTextDocument* document)
+{
+    mDocument = document;
+    clear();
+}
+
+void FilterView::setMatches(
+    std::shared_ptr<const TextBuffer> text,
+    std::shared_ptr<const MatchList> matches)
+{
+    if (text == nullptr || text != mText || mMatches == nullptr || matches == nullptr)
+    {
+        mText = std::move(text);
+        mMatches = std::move(matches);
+        mCurrentRow = -1;
+        mAnchorRow = -1;
+        mMaxLineWidth = 0;
+        clearLayouts();
+
+        updateScrollBars();
+        verticalScrollBar()->setValue(0);
+        horizontalScrollBar()->setValue(0);
+        viewport()->update();
+        return;
+    }
+
+    updateMatches(std::move(matches));
+}
+
+void FilterView::appendMatches(
+    std::shared_ptr<const TextBuffer> text,
+    std::shared_ptr<const MatchList> matches,
+    int firstChangedLine)
+{
+    if (mText == nullptr || mMatches == nullptr)
+    {
+        setMatches(std::move(text), std::move(matches));
+        return;
+    }
+
+    const bool wasAtEnd =
+        rowCount() == 0 || verticalScrollBar()->value() >= verticalScrollBar()->maximum();
+
+    mText = std::move(text);
+    for (auto it = mLayouts.begin(); it != mLayouts.end(); )
+    {
+        it = it.key() >= firstChangedLine ? mLayouts.erase(it) : std::next(it);
+    }
+
+    updateMatches(std::move(matches));
+
+    if (wasAtEnd)
+    {
+        verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+    }
+
+    // Matches may have been appended to the same list in place, which
+    // the difference does not see, and a changed line may be matched
+    // at the same areas as before. Rows before the first changed line
+    // are the same, the rest is repainted if any of it is on screen.
+    const int firstChangedRow = mMatches->nextIndex(firstChangedLine - 1);
+    const int visibleEnd = firstVisibleRow() + static_cast<int>(visibleLines().size());
+    if (firstChangedRow <= visibleEnd)
+    {
+        viewport()->update();
+    }
+}
+
+void FilterView::updateMatches(std::shared_ptr<const MatchList> matches)
+{
+    const int topLine = firstVisibleLineNum();
+    const int currentLine = mCurrentRow != -1 ? mMatches->lineAt(mCurrentRow) : -1;
+    const int anchorLine = mAnchorRow != -1 ? mMatches->lineAt(mAnchorRow) : -1;
+    const std::vector<int> oldLines = visibleLines();
+    const std::shared_ptr<const MatchList> oldMatches = mMatches;
+
+    mMatches = std::move(matches);
+
+    // Selection stays if both of its ends are still matched
+    mCurrentRow = currentLine != -1 ? mMatches->indexOf(currentLine) : -1;
+    mAnchorRow = anchorLine != -1 ? mMatches->indexOf(anchorLine) : -1;
+    const bool selectionChanged =
+        (currentLine != -1) && (mCurrentRow == -1 || mAnchorRow == -1);
+    if (mCurrentRow == -1 || mAnchorRow == -1)
+    {
+        mCurrentRow = -1;
+        mAnchorRow = -1;
+    }
+
+    // Keep the top line, or the first line below it, at the top.
+    // Scroll bar signals are blocked, so scrolling does not repaint everything.
+    {
+        const QSignalBlocker blocker(verticalScrollBar());
+        updateScrollBars();
+        verticalScrollBar()->setValue(
+            topLine != -1 ? mMatches->nextIndex(topLine - 1) : 0);
+    }
+
+    if (selectionChanged)
+    {
+        viewport()->update();
+        return;
+    }
+
+    // Rows above the first changed one are painted as they are
+    const std::vector<int> newLines = visibleLines();
+    size_t changed = 0;
+    while (changed < oldLines.size()
+           && changed < newLines.size()
+           && oldLines[changed] == newLines[changed]
+           && isSameMatch(newLines[changed], *oldMatches, *mMatches))
+    {
+        ++changed;
+    }
+
+    if (changed == oldLines.size() && changed == newLines.size())
+    {
+        return;
+    }
+
+    int top = 0;
+    for (size_t i = 0; i < changed; ++i)
+    {
+        top += rowHeight(firstVisibleRow() + static_cast<int>(i));
+    }
+    viewport()->update(0, top, viewport()->width(), viewport()->height() - top);
+}
+
+std::vector<int> FilterView::visibleLines() const
+{
+    std::vector<int> lines;
+    int y = 0;
+    for (int row = firstVisibleRow(); row < rowCount() && y < viewport()->height(); ++row)
+    {
+        lines.push_back(mMatches->lineAt(row));
+        y += rowHeight(row);
+    }
+    return lines;
+}
+
+bool FilterView::isSameMatch(
+    int lineNum,
+    const MatchList& oldMatches,
+    const MatchList& newMatches)
+{
+    const int oldRow = oldMatches.indexOf(lineNum);
+    const int newRow = newMatches.indexOf(lineNum);
+    if (oldRow == -1 || newRow == -1)
+    {
+        return false;
+    }
+
+    auto oldArea = oldMatches.areaBegin(oldRow);
+    auto newArea = newMatches.areaBegin(newRow);
+    if (oldMatches.areaEnd(oldRow) - oldArea != newMatches.areaEnd(newRow) - newArea)
+    {
+        return false;
+    }
+
+    for (; oldArea != oldMatches.areaEnd(oldRow); ++oldArea, ++newArea)
+    {
+        if (oldArea->begin != newArea->begin || oldArea->end != newArea->end)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void FilterView::clearLayouts()
+{
+    mLayouts.clear();
+}
+
+void FilterView::clear()
+{
+    setMatches(nullptr, nullptr);
+}
+
+void FilterView::setWordWrap(bool wordWrap)
+{
+    mWordWrap = wordWrap;
+    clearLayouts();
+    horizontalScrollBar()->setValue(0);
+    updateScrollBars();
+    viewport()->update();
+}
+
+int FilterView::firstVisibleLineNum() const
+{
+    return rowCount() > 0 ? mMatches->lineAt(firstVisibleRow()) : -1;
+}
+
+int FilterView::firstVisibleRow() const
+{
+    return verticalScrollBar()->value();
+}
+
+QString FilterView::lineText(int lineNum) const
+{
+    return mDocument != nullptr ? mDocument->findBlockByNumber(lineNum).text() : QString();
+}
+
+void FilterView::copyCurrentLine()
+{
+    if (mCurrentRow == -1)
+    {
+        return;
+    }
+
+    const int lineNum = mMatches->lineAt(mCurrentRow);
+    QApplication::clipboard()->setText(lineText(lineNum));
+}
+
+void FilterView::copySelectedLines()
+{
+    if (mCurrentRow == -1)
+    {
+        return;
+    }
+
+    QString text;
+    const int last = std::max(mAnchorRow, mCurrentRow);
+    for (int row = std::min(mAnchorRow, mCurrentRow); row <= last; ++row)
+    {
+        text += lineText(mMatches->lineAt(row));
+        text += '\n';
+    }
+    QApplication::clipboard()->setText(text);
+}
+
+void FilterView::layoutRow(int row, QTextLayout& layout) const
+{
+    layout.setText(lineText(mMatches->lineAt(row)));
+    layout.setFont(font());
+
+    QTextOption option;
+    option.setTabStopDistance(QFontMetricsF(font()).horizontalAdvance(' ') * 4);
+    option.setWrapMode(
+        mWordWrap ? QTextOption::WrapAtWordBoundaryOrAnywhere : QTextOption::NoWrap);
+    layout.setTextOption(option);
+
+    QList<QTextLayout::FormatRange> formats;
+    for (auto area = mMatches->areaBegin(row); area != mMatches->areaEnd(row); ++area)
+    {
+        QTextLayout::FormatRange range;
+        range.start = area->begin;
+        range.length = area->end - area->begin;
+        range.format.setBackground(Qt::yellow);
+        formats.append(range);
+    }
+    layout.setFormats(formats);
+
+    const int lineHeight = fontMetrics().height();
+    int y = 0;
+
+    layout.beginLayout();
+    for (QTextLine line = layout.createLine(); line.isValid(); line = layout.createLine())
+    {
+        line.setLineWidth(textAreaWidth());
+        line.setPosition(QPointF(0, y));
+        y += lineHeight;
+    }
+    layout.endLayout();
+}
+
+const QTextLayout& FilterView::rowLayout(int row) const
+{
+    const int lineNum = mMatches->lineAt(row);
+    const HighlightArea* begin = mMatches->areaBegin(row);
+    const HighlightArea* end = mMatches->areaEnd(row);
+
+    auto it = mLayouts.find(lineNum);
+    if (it != mLayouts.end()
+        && it->areas.size() == size_t(end - begin)
+        && std::equal(
+            begin,
+            end,
+            it->areas.begin(),
+            [](const HighlightArea& a, const HighlightArea& b)
+            {
+                return a.begin == b.begin && a.end == b.end;
+            }))
+    {
+        return *it->layout;
+    }
+
+    CachedLayout cached;
+    cached.areas.assign(begin, end);
+    cached.layout = std::make_shared<QTextLayout>();
+    layoutRow(row, *cached.layout);
+    return *mLayouts.insert(lineNum, cached)->layout;
+}
+
+int FilterView::rowHeight(int row) const
+{
+    if (!mWordWrap)
+    {
+        return fontMetrics().height();
+    }
+
+    return std::max(1, rowLayout(row).lineCount()) * fontMetrics().height();
+}
+
+int FilterView::rowAt(int y) const
+{
+    int bottom = 0;
+    for (int row = firstVisibleRow(); row < rowCount(); ++row)
+    {
+        bottom += rowHeight(row);
+        if (y < bottom)
+        {
+            return row;
+        }
+        if (bottom > viewport()->height())
+        {
+            break;
+        }
+    }
+    return -1;
+}
+
+int FilterView::visibleRowCount() const
+{
+    return std::max(1, viewport()->height() / fontMetrics().height());
+}
+
+int FilterView::gutterWidth() const
+{
+    int digits = 1;
+    int max = mText ? std::max(1, mText->lineCount()) : 1;
+    while (max >= 10)
+    {
+        max /= 10;
+        ++digits;
+    }
+
+    return 8 + fontMetrics().horizontalAdvance(QLatin1Char('9')) * digits;
+}
+
+int FilterView::textAreaWidth() const
+{
+    return std::max(1, viewport()->width() - gutterWidth() - 2 * kTextMargin);
+}
+
+void FilterView::updateScrollBars()
+{
+    const int pageRows = visibleRowCount();
+    verticalScrollBar()->setPageStep(pageRows);
+
+    // Wrapped rows can be taller than one line, so any row
+    // may have to be scrolled to the top to be seen
+    const int lastTopRow = mWordWrap ? rowCount() - 1 : rowCount() - pageRows;
+    verticalScrollBar()->setRange(0, std::max(0, lastTopRow));
+
+    const int width = textAreaWidth();
+    horizontalScrollBar()->setPageStep(width);
+    horizontalScrollBar()->setSingleStep(fontMetrics().averageCharWidth() * 4);
+    horizontalScrollBar()->setRange(
+        0,
+        mWordWrap ? 0 : std::max(0, mMaxLineWidth + kTextMargin - width));
+}
+
+void FilterView::setCurrentRow(int row, bool keepAnchor)
+{
+    if (rowCount() == 0)
+    {
+        return;
+    }
+
+    mCurrentRow = std::clamp(row, 0, rowCount() - 1);
+    if (!keepAnchor || mAnchorRow == -1)
+    {
+        mAnchorRow = mCurrentRow;
+    }
+
+    ensureRowVisible(mCurrentRow);
+    viewport()->update();
+}
+
+void FilterView::ensureRowVisible(int row)
+{
+    const int first = firstVisibleRow();
+    if (row < first)
+    {
+        verticalScrollBar()->setValue(row);
+        return;
+    }
+
+    // Walk up from the row until the viewport is full,
+    // so this costs one screen of rows wherever the row is
+    int height = 0;
+    for (int r = row; r >= first; --r)
+    {
+        height += rowHeight(r);
+        if (height > viewport()->height())
+        {
+            verticalScrollBar()->setValue(std::min(r + 1, row));
+            return;
+        }
+    }
+}
+
+void FilterView::paintEvent(QPaintEvent * /* event */)
+{
+    Trace::Scope scope("view.paint");
+
+    QPainter painter(viewport());
+
+    const int gutter = gutterWidth();
+    const QRect area = viewport()->rect();
+    painter.fillRect(0, 0, gutter, area.height(), kGutterColor);
+
+    if (rowCount() == 0)
+    {
+        return;
+    }
+
+    const int lineHeight = fontMetrics().height();
+    const int textX = gutter + kTextMargin - horizontalScrollBar()->value();
+    const QRect textClip(gutter, 0, area.width() - gutter, area.height());
+
+    const int selectionBegin = std::min(mAnchorRow, mCurrentRow);
+    const int selectionEnd = std::max(mAnchorRow, mCurrentRow);
+
+    int maxLineWidth = mMaxLineWidth;
+    const int layoutCount = mLayouts.size();
+    QSet<int> paintedLines;
+    int y = 0;
+    for (int row = firstVisibleRow(); row < rowCount() && y < area.height(); ++row)
+    {
+        const QTextLayout& layout = rowLayout(row);
+        paintedLines.insert(mMatches->lineAt(row));
+        const int height = std::max(1, layout.lineCount()) * lineHeight;
+
+        if (mCurrentRow != -1 && row >= selectionBegin && row <= selectionEnd)
+        {
+            painter.fillRect(gutter, y, area.width() - gutter, height, kSelectedRowColor);
+        }
+
+        painter.save();
+        painter.setClipRect(textClip);
+        painter.setPen(palette().text().color());
+        layout.draw(&painter, QPointF(textX, y));
+        painter.restore();
+
+        painter.setPen(kLineNumberColor);
+        painter.drawText(
+            0,
+            y,
+            gutter - 5,
+            lineHeight,
+            Qt::AlignRight,
+            QString::number(mMatches->lineAt(row) + 1));
+
+        if (!mWordWrap && layout.lineCount() > 0)
+        {
+            maxLineWidth = std::max(
+                maxLineWidth,
+                static_cast<int>(std::ceil(layout.lineAt(0).naturalTextWidth())));
+        }
+
+        y += height;
+    }
+
+    scope.setCounter("rows", paintedLines.size());
+    scope.setCounter("newLayouts", std::max(0, int(mLayouts.size()) - layoutCount));
+
+    // Only rows on screen are worth keeping
+    for (auto it = mLayouts.begin(); it != mLayouts.end(); )
+    {
+        it = paintedLines.contains(it.key()) ? std::next(it) : mLayouts.erase(it);
+    }
+
+    // Width of lines which were never on screen is not known,
+    // so the scroll range grows as wider lines show up
+    if (maxLineWidth > mMaxLineWidth)
+    {
+        mMaxLineWidth = maxLineWidth;
+        updateScrollBars();
+    }
+}
+
+void FilterView::scrollContentsBy(int /* dx */, int /* dy */)
+{
+    // Scroll bars count rows, not pixels
+    viewport()->update();
+}
+
+void FilterView::resizeEvent(QResizeEvent *event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    clearLayouts();
+    updateScrollBars();
+}
+
+void FilterView::changeEvent(QEvent *event)
+{
+    QAbstractScrollArea::changeEvent(event);
+
+    if (event->type() == QEvent::FontChange)
+    {
+        mMaxLineWidth = 0;
+        clearLayouts();
+        updateScrollBars();
+        viewport()->update();
+    }
+}
+
+void FilterView::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() != Qt::LeftButton)
+    {
+        QAbstractScrollArea::mousePressEvent(event);
+        return;
+    }
+
+    const int row = rowAt(event->pos().y());
+    if (row == -1)
+    {
+        return;
+    }
+
+    // Same as in the editor: Ctrl+click copies the line
+    if (event->modifiers().testFlag(Qt::ControlModifier))
+    {
+        setCurrentRow(row, false);
+        copyCurrentLine();
+        return;
+    }
+
+    setCurrentRow(row, event->modifiers().testFlag(Qt::ShiftModifier));
+}
+
+void FilterView::mouseDoubleClickEvent(QMouseEvent *event)
+{
+    const int row = rowAt(event->pos().y());
+    if (event->button() == Qt::LeftButton && row != -1)
+    {
+        emit lineActivated(mMatches->lineAt(row));
+    }
+}
+
+void FilterView::keyPressEvent(QKeyEvent *event)
+{
+    if (event->matches(QKeySequence::Copy))
+    {
+        copySelectedLines();
+        return;
+    }
+
+    const bool keepAnchor = event->modifiers().testFlag(Qt::ShiftModifier);
+    const bool hasCurrentRow = mCurrentRow != -1;
+
+    switch (event->key())
+    {
+    case Qt::Key_Up:
+        setCurrentRow(hasCurrentRow ? mCurrentRow - 1 : firstVisibleRow(), keepAnchor);
+        break;
+    case Qt::Key_Down:
+        setCurrentRow(hasCurrentRow ? mCurrentRow + 1 : firstVisibleRow(), keepAnchor);
+        break;
+    case Qt::Key_PageUp:
+        setCurrentRow(
+            (hasCurrentRow ? mCurrentRow : firstVisibleRow()) - visibleRowCount(),
+            keepAnchor);
+        break;
+    case Qt::Key_PageDown:
+        setCurrentRow(
+            (hasCurrentRow ? mCurrentRow : firstVisibleRow()) + visibleRowCount(),
+            keepAnchor);
+        break;
+    case Qt::Key_Home:
+        setCurrentRow(0, keepAnchor);
+        break;
+    case Qt::Key_End:
+        setCurrentRow(rowCount() - 1, keepAnchor);
+        break;
+    case Qt::Key_Return:
+    case Qt::Key_Enter:
+        if (hasCurrentRow)
+        {
+            emit lineActivated(mMatches->lineAt(mCurrentRow));
+        }
+        break;
+    default:
+        QAbstractScrollArea::keyPressEvent(event);
+    }
+}
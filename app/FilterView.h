@@ -0,0 +1,140 @@
+#ifndef FILTERVIEW_H
+#define FILTERVIEW_H
+
+#include "MatchList.h"
+#include "TextBuffer.h"
+
+#include <QAbstractScrollArea>
+#include <QHash>
+#include <QTextLayout>
+#include <memory>
+#include <vector>
+
+class QTextDocument;
+
+// Read-only view of the lines matched by a filter.
+// Lines are read straight from the editor document, and only the rows
+// on screen are laid out and painted, so showing a filter result
+// costs the same for ten matched lines and for a million.
+//
+// Scroll bar counts rows, i.e. matched lines, not pixels.
+class FilterView : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+public:
+
+    explicit FilterView(QWidget *parent = Q_NULLPTR);
+
+    // Document the text of matched lines is read from.
+    // Its lines are the lines of the TextBuffer passed to setMatches().
+    void setTextDocument(const QTextDocument* document);
+
+    // Show matched lines of text.
+    // For new text the first match is shown at the top. A new result
+    // for the same text is applied as a difference: the top line stays
+    // where it was, layouts of rows which stay on screen are reused,
+    // and only rows which changed are repainted.
+    void setMatches(
+        std::shared_ptr<const TextBuffer> text,
+        std::shared_ptr<const MatchList> matches);
+    void clear();
+
+    // Show matches of text which continues the text shown now,
+    // lines from firstChangedLine on are new or changed. matches may
+    // be the list shown now, with the new matches appended in place.
+    // If the last row was on screen, the view scrolls so it stays there.
+    void appendMatches(
+        std::shared_ptr<const TextBuffer> text,
+        std::shared_ptr<const MatchList> matches,
+        int firstChangedLine);
+
+    void setWordWrap(bool wordWrap);
+
+    // Line number in the text of the top row, -1 if there are no rows
+    int firstVisibleLineNum() const;
+
+    // Copy line of the current row, without line break
+    void copyCurrentLine();
+
+    // Copy lines of all selected rows, each ending with line break
+    void copySelectedLines();
+
+signals:
+
+    // Row of the line was double clicked
+    void lineActivated(int lineNum);
+
+protected:
+
+    void paintEvent(QPaintEvent *event) override;
+    void scrollContentsBy(int dx, int dy) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void changeEvent(QEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseDoubleClickEvent(QMouseEvent *event) override;
+    void keyPressEvent(QKeyEvent *event) override;
+
+private:
+
+    int rowCount() const { return mMatches ? mMatches->size() : 0; }
+    int firstVisibleRow() const;
+
+    QString lineText(int lineNum) const;
+
+    // Lay out the line of the row at the current width
+    void layoutRow(int row, QTextLayout& layout) const;
+    const QTextLayout& rowLayout(int row) const;
+    int rowHeight(int row) const;
+
+    // Apply new matches of the same text as a difference
+    void updateMatches(std::shared_ptr<const MatchList> matches);
+
+    // Line numbers of the rows which fit on screen
+    std::vector<int> visibleLines() const;
+
+    // True if line is matched at the same areas in both lists
+    static bool isSameMatch(
+        int lineNum,
+        const MatchList& oldMatches,
+        const MatchList& newMatches);
+
+    void clearLayouts();
+
+    // Row at viewport position y, -1 below the last row
+    int rowAt(int y) const;
+
+    void setCurrentRow(int row, bool keepAnchor);
+    void ensureRowVisible(int row);
+    int visibleRowCount() const;
+
+    void updateScrollBars();
+    int gutterWidth() const;
+    int textAreaWidth() const;
+
+    const QTextDocument* mDocument;
+    std::shared_ptr<const TextBuffer> mText;
+    std::shared_ptr<const MatchList> mMatches;
+
+    bool mWordWrap;
+
+    // Selected rows are between anchor and current row
+    int mCurrentRow;
+    int mAnchorRow;
+
+    // Widest line painted so far, for the horizontal scroll bar
+    int mMaxLineWidth;
+
+    struct CachedLayout
+    {
+        std::vector<HighlightArea> areas;
+        std::shared_ptr<QTextLayout> layout;
+    };
+
+    // Layouts of the rows on screen, keyed by line number.
+    // They are kept across results of the same text, so rows
+    // which stay on screen are not laid out again.
+    mutable QHash<int, CachedLayout> mLayouts;
+};
+
+#endif // FILTERVIEW_H
@@ -0,0 +1,1460 @@
+#include "MainWindow.h"
+#include "qscrollbar.h"
+#include "qtextobject.h"
+#include "ui_MainWindow.h"
+#include <QDebug>
+#include <QMenu>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QMessageBox>
+#include <QTextDocumentFragment>
+#include "SettingsWindow.h"
+#include "Settings.h"
+#include "Document.h"
+#include <QTimer>
+#include <QShortcut>
+#include <QProgressBar>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cstring>
+#include "FileManager.h"
+#include "FilterView.h"
+#include "Trace.h"
+#include <QLabel>
+#include <QLocale>
+#include <QStatusBar>
+
+MainWindow::MainWindow(QWidget *parent)
+    : QMainWindow(parent)
+    , ui(new Ui::MainWindow)
+    , rootDocument(nullptr)
+    , mPreFilterTopBlock(0)
+    , mFilterGeneration(0)
+    , mRunningFilterGeneration(0)
+    , mHasPendingFilter(false)
+    , mIsFilterRunning(false)
+    , mFilterCostPerChar(0)
+    , mIsRefilterAfterEdit(false)
+    , mLoadGeneration(0)
+    , mLoadChunkSlots(kMaxPendingLoadChunks)
+    , mIsLoading(false)
+    , mLoadProgress(nullptr)
+    , mLoadedSize(0)
+    , mLoadedEncoding(TextCodec::Encoding::Utf8)
+    , mIsAppendingText(false)
+    , mHasPendingAppend(false)
+    , mSaveBlockNum(0)
+    , mIsSaving(false)
+    , mEditRevision(0)
+    , mSaveEditRevision(0)
+    , mDocumentGeneration(0)
+    , mSaveDocumentGeneration(0)
+    , mTimingsLabel(nullptr)
+    , mTimingsStart(0)
+    , mIsRecordingTrace(false)
+    , mFilterBusyIndicator(nullptr)
+{
+    ui->setupUi(this);
+
+    // Busy indicator next to the filter field. It is shown with a delay,
+    // so it does not flicker when filtering is fast.
+    mFilterBusyIndicator = new QProgressBar(this);
+    mFilterBusyIndicator->setRange(0, 0);
+    mFilterBusyIndicator->setTextVisible(false);
+    mFilterBusyIndicator->setMaximumSize(60, 10);
+    mFilterBusyIndicator->setVisible(false);
+    ui->horizontalLayout->insertWidget(2, mFilterBusyIndicator);
+
+    mFilterBusyTimer.setSingleShot(true);
+    mFilterBusyTimer.setInterval(kFilterBusyDelayMs);
+    connect(&mFilterBusyTimer, &QTimer::timeout,
+            mFilterBusyIndicator, &QWidget::show);
+
+    // Progress of loading a file, shown while it is read
+    mLoadProgress = new QProgressBar(this);
+    mLoadProgress->setRange(0, 100);
+    mLoadProgress->setTextVisible(false);
+    mLoadProgress->setMaximumSize(60, 10);
+    mLoadProgress->setVisible(false);
+    ui->horizontalLayout->insertWidget(2, mLoadProgress);
+
+    // Timings of the last operation, shown if enabled in the settings
+    mTimingsLabel = new QLabel(this);
+    mTimingsLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    statusBar()->addWidget(mTimingsLabel, 1);
+
+    mTimingsTimer.setSingleShot(true);
+    mTimingsTimer.setInterval(kTimingsDelayMs);
+    connect(&mTimingsTimer, &QTimer::timeout,
+            this, &MainWindow::updateTimings);
+
+    connect(&mLoadWatcher, &QFutureWatcherBase::finished,
+            this, &MainWindow::onLoadFinished);
+
+    connect(&mSaveWatcher, &QFutureWatcherBase::finished,
+            this, &MainWindow::onSaveFinished);
+
+    mSaveSliceTimer.setSingleShot(true);
+    mSaveSliceTimer.setInterval(0);
+    connect(&mSaveSliceTimer, &QTimer::timeout,
+            this, &MainWindow::collectSaveLines);
+
+    connect(&mFollower, &FileFollower::textAppended,
+            this, &MainWindow::appendFollowedText);
+    connect(&mFollower, &FileFollower::fileReset,
+            this, &MainWindow::onFollowedFileReset);
+
+    connect(&mFilterWatcher, &QFutureWatcherBase::finished,
+            this, &MainWindow::onFilterFinished);
+
+    mFilterDelayTimer.setSingleShot(true);
+    connect(&mFilterDelayTimer, &QTimer::timeout,
+            this, &MainWindow::startDelayedFilter);
+
+    mRefilterTimer.setSingleShot(true);
+    mRefilterTimer.setInterval(kRefilterDelayMs);
+    connect(&mRefilterTimer, &QTimer::timeout,
+            this, &MainWindow::refilterEditedText);
+
+    // Pre-load icons once. Previously a new QIcon was constructed from the
+    // resource path inside updateSaveAndMenuButtonIcons() on every call,
+    // which fired on every keystroke via on_plainTextEdit_textChanged.
+    mIconMenuClean   = QIcon(":/resources/128x128/menu.png");
+    mIconMenuChanged = QIcon(":/resources/128x128/menu_changed.png");
+    mIconSaveClean   = QIcon(":/resources/128x128/save.png");
+    mIconSaveChanged = QIcon(":/resources/128x128/save_changed.png");
+
+    // Hide menu panel
+    on_pushButtonMenu_clicked(false);
+
+    ui->frameInfo->setVisible(false);
+
+    // Shown instead of the editor while a filter result is displayed
+    ui->filterView->setVisible(false);
+    ui->filterView->setTextDocument(ui->plainTextEdit->document());
+    connect(ui->filterView, &FilterView::lineActivated,
+            this, &MainWindow::showLineInEditor);
+
+    // Set position
+    restoreGeometry(Settings::getInstance().getWindowGeometry());
+
+    applySettings();
+    loadLastFile();
+
+    ui->lineEditSearch->installEventFilter(this);
+
+    // Wire the built-in X (clear) button inside lineEditSearch to our slot.
+    // clearButtonEnabled is set in the .ui, so the action already exists here.
+    auto* clearAction = ui->lineEditSearch->findChild<QAction*>();
+    if (clearAction)
+    {
+        connect(clearAction,
+                &QAction::triggered,
+                this,
+                &MainWindow::clearFilter);
+    }
+
+    // Ctrl+F shortcut — focuses and clears the filter field.
+    auto* ctrlF = new QShortcut(QKeySequence(Qt::CTRL | Qt::Key_F), this);
+    connect(ctrlF,
+            &QShortcut::activated,
+            this,
+            &MainWindow::clearFilter);
+}
+
+MainWindow::~MainWindow()
+{
+    // Cancel running filter pass and file load, they call back into this object
+    ++mFilterGeneration;
+    mFilterWatcher.waitForFinished();
+    cancelLoad();
+
+    delete ui;
+}
+
+void MainWindow::applySettings()
+{
+    ui->plainTextEdit->setFont(Settings::getInstance().getFont());
+    ui->plainTextEdit->updateTabWidth();
+    ui->filterView->setFont(Settings::getInstance().getFont());
+    Document::setWorkerCount(Settings::getInstance().getFilterThreads());
+    Document::setIndexingEnabled(Settings::getInstance().isIndexLargeFiles());
+    Document::setResultCacheBudget(
+        size_t(Settings::getInstance().getResultCacheSize()) * 1024 * 1024);
+
+    // Trace of the session is written when recording is turned off
+    const bool isRecordTrace = Settings::getInstance().isRecordTrace();
+    if (mIsRecordingTrace && !isRecordTrace)
+    {
+        writeTrace();
+    }
+    mIsRecordingTrace = isRecordTrace;
+    Trace::setEnabled(isRecordTrace || Settings::getInstance().isShowTimings());
+    statusBar()->setVisible(Settings::getInstance().isShowTimings());
+    setAlwaysOnTop();
+    setWordWrap();
+    setRecentFiles();
+}
+
+void MainWindow::closeEvent(QCloseEvent *event)
+{
+    Settings::getInstance().setWindowGeometry(saveGeometry());
+    if (ui->plainTextEdit->isDirty())
+    {
+        QMessageBox::StandardButton reply =
+            QMessageBox::question(
+                this,
+                "Text Filter",
+                "Save before quit?",
+                QMessageBox::Yes|QMessageBox::No|QMessageBox::Cancel);
+
+        if (reply == QMessageBox::Yes)
+        {
+            QString filename = Settings::getInstance().getFilename();
+            saveFile(filename);
+        }
+        else if (reply == QMessageBox::Cancel)
+        {
+            event->ignore();
+            return;
+        }
+    }
+
+    // Running save has to reach the disk before the process exits
+    waitForSave();
+
+    if (mIsRecordingTrace)
+    {
+        writeTrace();
+    }
+
+    // Settings::setXxx() only schedules a debounced write (fires ~400ms
+    // later via mSaveTimer). The application can exit before that timer
+    // ever runs, silently dropping every setting changed in this session —
+    // including the saveGeometry() call right above. flushNow() cancels the
+    // pending timer and writes immediately, guaranteeing the final state
+    // reaches disk before the process exits.
+    Settings::getInstance().flushNow();
+}
+
+void MainWindow::on_lineEditSearch_textChanged(const QString &filter)
+{
+    startTimings();
+
+    // Whatever is being filtered right now is outdated
+    ++mFilterGeneration;
+    mIsRefilterAfterEdit = false;
+
+    if (filter.isEmpty())
+    {
+        mHasPendingFilter = false;
+        mFilterDelayTimer.stop();
+        mRefilterTimer.stop();
+        showFilterView(false);
+        ui->filterView->clear();
+        ui->plainTextEdit->setMatches(nullptr);
+        ui->plainTextEdit->clearCurrentMatch();
+
+        if (rootDocument != nullptr)
+        {
+            // The next filter session indexes only lines edited meanwhile
+            mTrigramIndex = rootDocument->getTrigramIndex();
+            rootDocument.reset();
+            mHasPendingAppend = false;
+
+            // Defer scroll restore: showing the editor again triggers
+            // layout/range updates that Qt processes after this slot returns,
+            // which would override setValue.
+            // singleShot(0) fires after those pending events are processed.
+            QTimer::singleShot(0, this, &MainWindow::restoreScrollPosition);
+        }
+    }
+    else
+    {
+        if (rootDocument == nullptr)
+        {
+            Trace::Scope scope("document.create");
+            rootDocument.reset(
+                new Document(ui->plainTextEdit->textBuffer(), mTrigramIndex));
+            mTrigramIndex.reset();
+            mHasPendingAppend = false;
+        }
+
+        scheduleFilter(filter);
+    }
+
+    updateNavigationButtons();
+}
+
+void MainWindow::scheduleFilter(const QString& filter)
+{
+    const double costMs = filterCostMs();
+    const bool isCheap = costMs < kCheapFilterMs;
+
+    // Short filters match most lines, so they are the most expensive.
+    // The threshold holds them back only where passes are not cheap.
+    if (!isCheap && filter.length() < Settings::getInstance().getFilterThreshold())
+    {
+        // Neither a filter typed before nor the matches of one
+        // outlive the filter text they were for
+        mFilterDelayTimer.stop();
+        mHasPendingFilter = false;
+        mDelayedFilter.clear();
+        mIsRefilterAfterEdit = false;
+        rootDocument->setFilterResult(QString(), nullptr);
+        ui->filterView->clear();
+        ui->plainTextEdit->setMatches(nullptr);
+        ui->plainTextEdit->clearCurrentMatch();
+        updateNavigationButtons();
+        return;
+    }
+
+    if (isCheap)
+    {
+        mFilterDelayTimer.stop();
+        startFilter(filter);
+        return;
+    }
+
+    if (!mFilterDelayTimer.isActive())
+    {
+        mFilterDelayStart.start();
+    }
+    mDelayedFilter = filter;
+
+    const int delay = std::min(kMaxFilterDelayMs, int(costMs));
+    const int remaining = kMaxFilterDelayMs - int(mFilterDelayStart.elapsed());
+    mFilterDelayTimer.start(std::max(0, std::min(delay, remaining)));
+}
+
+void MainWindow::startDelayedFilter()
+{
+    if (rootDocument != nullptr)
+    {
+        startFilter(mDelayedFilter);
+    }
+}
+
+void MainWindow::startFilter(const QString& filter)
+{
+    // Running pass sees the new generation and stops soon,
+    // the latest filter is started once it is finished
+    if (mIsFilterRunning)
+    {
+        mPendingFilter = filter;
+        mHasPendingFilter = true;
+        return;
+    }
+
+    const int generation = mFilterGeneration;
+    mIsFilterRunning = true;
+    mRunningFilterGeneration = generation;
+    mRunningFilter = filter;
+    mFilterPassTimer.start();
+
+    Document::FilterTask task = rootDocument->createFilterTask(filter);
+    mFilterWatcher.setFuture(QtConcurrent::run(
+        [this, task, generation]()
+        {
+            return Document::runFilterTask(
+                task,
+                [this, generation]() { return mFilterGeneration != generation; });
+        }));
+
+    if (!mFilterBusyIndicator->isVisible())
+    {
+        mFilterBusyTimer.start();
+    }
+}
+
+void MainWindow::onFilterFinished()
+{
+    mIsFilterRunning = false;
+    auto result = mFilterWatcher.result();
+    updateFilterCost(mFilterPassTimer.elapsed(), result == nullptr);
+
+    if (mHasPendingFilter && rootDocument != nullptr)
+    {
+        mHasPendingFilter = false;
+        appendPendingText();
+        startFilter(mPendingFilter);
+        return;
+    }
+
+    mFilterBusyTimer.stop();
+    mFilterBusyIndicator->setVisible(false);
+
+    if (result == nullptr
+        || rootDocument == nullptr
+        || mRunningFilterGeneration != mFilterGeneration)
+    {
+        appendPendingText();
+        return;
+    }
+
+    rootDocument->setFilterResult(mRunningFilter, result);
+    {
+        Trace::Scope scope("view.setMatches");
+        scope.setCounter("matches", rootDocument->getFilteredLineCount());
+        ui->filterView->setMatches(rootDocument->getText(), rootDocument->getMatches());
+        ui->plainTextEdit->setMatches(rootDocument->getMatches());
+    }
+
+    // Result is of the text before the lines followed meanwhile
+    appendPendingText();
+
+    if (mIsRefilterAfterEdit)
+    {
+        // Keep the editor where the user is typing
+        mIsRefilterAfterEdit = false;
+        const int lineNum = rootDocument->getCurrentHighlightedLineNum();
+        const int n = rootDocument->getMatches()->indexOf(lineNum);
+        if (n != -1)
+        {
+            ui->plainTextEdit->setCurrentMatch(
+                lineNum,
+                rootDocument->getMatches()->areaBegin(n),
+                rootDocument->getMatches()->areaEnd(n));
+        }
+        else
+        {
+            ui->plainTextEdit->clearCurrentMatch();
+        }
+    }
+    else
+    {
+        showFilterView(true);
+        ui->plainTextEdit->clearCurrentMatch();
+    }
+
+    updateNavigationButtons();
+    showTimings(tr("Filter"));
+}
+
+double MainWindow::filterCostMs() const
+{
+    return mFilterCostPerChar * ui->plainTextEdit->document()->characterCount();
+}
+
+void MainWindow::updateFilterCost(qint64 elapsedMs, bool isCancelled)
+{
+    const double cost =
+        double(elapsedMs) / std::max(1, ui->plainTextEdit->document()->characterCount());
+
+    // A cancelled pass stopped early, a whole one costs at least as much.
+    // Otherwise every pass of a fast typist is cancelled, and the cost
+    // never rises above the one of a small text.
+    if (isCancelled)
+    {
+        mFilterCostPerChar = std::max(mFilterCostPerChar, cost);
+        return;
+    }
+
+    // Recent passes weigh most, one slow pass does not
+    // make typing sluggish for long
+    if (mFilterCostPerChar == 0)
+    {
+        mFilterCostPerChar = cost;
+    }
+    else
+    {
+        mFilterCostPerChar = 0.7 * mFilterCostPerChar + 0.3 * cost;
+    }
+}
+
+void MainWindow::refilterEditedText()
+{
+    if (rootDocument == nullptr)
+    {
+        return;
+    }
+
+    startTimings();
+
+    // Current line is kept, the edit moved it at most by a few lines
+    const int lineNum = rootDocument->getCurrentHighlightedLineNum();
+    mTrigramIndex = rootDocument->getTrigramIndex();
+    {
+        Trace::Scope scope("document.create");
+        rootDocument.reset(new Document(ui->plainTextEdit->textBuffer(), mTrigramIndex));
+    }
+    rootDocument->setCurrentHighlightedLineNum(lineNum);
+    mTrigramIndex.reset();
+
+    // Snapshot has the followed text which was waiting
+    mHasPendingAppend = false;
+
+    const QString filter = ui->lineEditSearch->text();
+    ++mFilterGeneration;
+    mIsRefilterAfterEdit = true;
+    scheduleFilter(filter);
+}
+
+void MainWindow::showFilterView(bool visible)
+{
+    ui->filterView->setVisible(visible);
+    ui->plainTextEdit->setVisible(!visible);
+}
+
+void MainWindow::showLineInEditor(int lineNum)
+{
+    if (rootDocument == nullptr)
+    {
+        return;
+    }
+
+    rootDocument->setCurrentHighlightedLineNum(lineNum);
+    showCurrentMatch();
+    ui->plainTextEdit->setFocus();
+}
+
+void MainWindow::showCurrentMatch()
+{
+    const int lineNum = rootDocument->getCurrentHighlightedLineNum();
+    if (lineNum == -1)
+    {
+        return;
+    }
+
+    Trace::Scope scope("editor.showMatch");
+
+    showFilterView(false);
+
+    auto matches = rootDocument->getMatches();
+    const int n = matches->indexOf(lineNum);
+    if (n != -1)
+    {
+        ui->plainTextEdit->setCurrentMatch(
+            lineNum,
+            matches->areaBegin(n),
+            matches->areaEnd(n));
+    }
+
+    QTextBlock block = ui->plainTextEdit->document()->findBlockByNumber(lineNum);
+    if (block.isValid())
+    {
+        QTextCursor cursor(block);
+        ui->plainTextEdit->setTextCursor(cursor);
+        ui->plainTextEdit->centerCursor();
+    }
+}
+
+void MainWindow::updateNavigationButtons()
+{
+    bool isTextFiltered = rootDocument && rootDocument->getFilteredLineCount() > 0;
+    ui->toolButtonPrevious->setEnabled(isTextFiltered);
+    ui->toolButtonNext->setEnabled(isTextFiltered);
+}
+
+void MainWindow::loadLastFile()
+{
+    QString filename = Settings::getInstance().getFilename();
+
+    ui->lineEditSearch->clear();
+    mTrigramIndex.reset();
+    startLoad(filename);
+
+    ui->toolButtonPrevious->setEnabled(false);
+    ui->toolButtonNext->setEnabled(false);
+    setWindowTitle(filename + (filename.isEmpty() ? "" : " - ") + "Text Filter");
+    updateSaveAndMenuButtonIcons();
+}
+
+void MainWindow::setAlwaysOnTop()
+{
+    Qt::WindowFlags flags = this->windowFlags();
+    if (Settings::getInstance().isAlwaysOnTop())
+    {
+        flags = flags | Qt::WindowStaysOnTopHint;
+    }
+    else
+    {
+        flags = flags & ~Qt::WindowStaysOnTopHint;
+    }
+    this->setWindowFlags(flags);
+    this->show();
+
+    ui->toolButtonAlwaysOnTop->setChecked(
+        Settings::getInstance().isAlwaysOnTop());
+}
+
+void MainWindow::setWordWrap()
+{
+    QPlainTextEdit::LineWrapMode mode =
+        Settings::getInstance().isWordWrap()
+            ? QPlainTextEdit::WidgetWidth
+            : QPlainTextEdit::NoWrap;
+
+    ui->plainTextEdit->setLineWrapMode(mode);
+    ui->filterView->setWordWrap(Settings::getInstance().isWordWrap());
+    ui->toolButtonWordWrap->setChecked(Settings::getInstance().isWordWrap());
+}
+
+void MainWindow::setFollowFile()
+{
+    const bool follow = Settings::getInstance().isFollowFile();
+    ui->toolButtonFollow->setChecked(follow);
+
+    // File is followed from where its load ended
+    const QString filename = Settings::getInstance().getFilename();
+    if (follow && !filename.isEmpty() && !mIsLoading)
+    {
+        if (!mFollower.isFollowing())
+        {
+            mFollower.follow(filename, mLoadedSize, mLoadedEncoding);
+        }
+    }
+    else
+    {
+        mFollower.stop();
+    }
+
+    // Followed text mirrors the file, and appends are not undoable edits
+    const bool isFollowing = mFollower.isFollowing();
+    ui->plainTextEdit->setReadOnly(mIsLoading || isFollowing);
+    ui->plainTextEdit->document()->setUndoRedoEnabled(!mIsLoading && !isFollowing);
+}
+
+void MainWindow::appendFollowedText(const QString& text)
+{
+    QScrollBar* scrollBar = ui->plainTextEdit->verticalScrollBar();
+    const bool wasAtEnd = scrollBar->value() >= scrollBar->maximum();
+    const bool wasModified = ui->plainTextEdit->document()->isModified();
+
+    mIsAppendingText = true;
+    QTextCursor cursor(ui->plainTextEdit->document());
+    cursor.movePosition(QTextCursor::End);
+    cursor.insertText(text);
+    ui->plainTextEdit->document()->setModified(wasModified);
+    mIsAppendingText = false;
+
+    // Like tail -f, the end stays on screen unless the user scrolled away
+    if (wasAtEnd)
+    {
+        scrollBar->setValue(scrollBar->maximum());
+    }
+
+    filterAppendedText();
+}
+
+void MainWindow::filterAppendedText()
+{
+    if (rootDocument == nullptr)
+    {
+        return;
+    }
+
+    // A running pass filters the text it was started on, the new
+    // lines wait until its result is there and are filtered once,
+    // on top of it. The watcher stops running before its finished
+    // signal arrives, the text waits for the signal too.
+    mHasPendingAppend = true;
+    if (!mIsFilterRunning)
+    {
+        appendPendingText();
+    }
+}
+
+void MainWindow::appendPendingText()
+{
+    if (rootDocument == nullptr || !mHasPendingAppend)
+    {
+        return;
+    }
+    mHasPendingAppend = false;
+
+    // Only the new lines are filtered
+    const int firstChangedLine = rootDocument->getText()->lineCount() - 1;
+    if (!rootDocument->appendText(ui->plainTextEdit->textBuffer()))
+    {
+        return;
+    }
+
+    ui->filterView->appendMatches(
+        rootDocument->getText(),
+        rootDocument->getMatches(),
+        firstChangedLine);
+    ui->plainTextEdit->setMatches(rootDocument->getMatches());
+    updateNavigationButtons();
+}
+
+void MainWindow::onFollowedFileReset()
+{
+    // Truncated or rotated, load it again, the filter stays
+    startLoad(Settings::getInstance().getFilename());
+}
+
+void MainWindow::loadFile(const QString &filename)
+{
+    if (filename.isEmpty())
+    {
+        return;
+    }
+
+    if (ui->plainTextEdit->isDirty())
+    {
+        QMessageBox::StandardButton reply =
+            QMessageBox::question(
+                this,
+                "Text Filter",
+                "Save changed file?",
+                QMessageBox::Yes|QMessageBox::No|QMessageBox::Cancel);
+
+        if (reply == QMessageBox::Yes)
+        {
+            QString oldFile = Settings::getInstance().getFilename();
+            saveFile(oldFile);
+        }
+        else if (reply == QMessageBox::Cancel)
+        {
+            return;
+        }
+    }
+
+    ui->lineEditSearch->clear();
+    mTrigramIndex.reset();
+    startLoad(filename);
+    updateFilename(filename);
+    updateSaveAndMenuButtonIcons();
+}
+
+void MainWindow::startLoad(const QString& filename)
+{
+    cancelLoad();
+    mFollower.stop();
+    mHasPendingAppend = false;
+    mLoadedSize = 0;
+    mLoadedEncoding = TextCodec::Encoding::Utf8;
+    ++mDocumentGeneration;
+
+    ui->plainTextEdit->setPlainText("");
+    if (filename.isEmpty())
+    {
+        setFollowFile();
+        return;
+    }
+
+    startTimings();
+
+    // Appended chunks are not edits, and the text cannot be edited
+    // until all of it is there
+    ui->plainTextEdit->document()->setUndoRedoEnabled(false);
+    ui->plainTextEdit->setReadOnly(true);
+    mIsLoading = true;
+
+    mLoadProgress->setValue(0);
+    mLoadProgress->setVisible(true);
+
+    const int generation = mLoadGeneration;
+    mLoadWatcher.setFuture(QtConcurrent::run(
+        [this, filename, generation]()
+        {
+            auto isCancelled = [this, generation]() { return mLoadGeneration != generation; };
+
+            // Set before the first chunk, the follower decodes the rest of the file with it
+            TextCodec::Encoding encoding = TextCodec::Encoding::Utf8;
+
+            FileManager::loadChunks(
+                filename,
+                [this, generation, &isCancelled, &encoding](const QString& chunk, qint64 bytesRead, qint64 size)
+                {
+                    // Appending a queued chunk or cancelling the load wakes it
+                    mLoadChunkSlots.acquire();
+                    if (isCancelled())
+                    {
+                        return;
+                    }
+
+                    QMetaObject::invokeMethod(
+                        this,
+                        [this, generation, chunk, bytesRead, size, encoding]()
+                        {
+                            appendLoadedChunk(generation, chunk, bytesRead, size, encoding);
+                        },
+                        Qt::QueuedConnection);
+                },
+                isCancelled,
+                &encoding);
+        }));
+
+    setFollowFile();
+}
+
+void MainWindow::cancelLoad()
+{
+    ++mLoadGeneration;
+    mLoadChunkSlots.release();
+    mLoadWatcher.waitForFinished();
+
+    // Chunks still queued are dropped without giving their slot back
+    mLoadChunkSlots.acquire(mLoadChunkSlots.available());
+    mLoadChunkSlots.release(kMaxPendingLoadChunks);
+    if (mIsLoading)
+    {
+        finishLoad();
+    }
+}
+
+void MainWindow::appendLoadedChunk(
+    int generation,
+    const QString& chunk,
+    qint64 bytesRead,
+    qint64 size,
+    TextCodec::Encoding encoding)
+{
+    if (generation != mLoadGeneration)
+    {
+        return;
+    }
+    mLoadChunkSlots.release();
+
+    Trace::Scope scope("editor.appendChunk");
+    scope.setCounter("characters", chunk.size());
+
+    mIsAppendingText = true;
+    QTextCursor cursor(ui->plainTextEdit->document());
+    cursor.movePosition(QTextCursor::End);
+    cursor.insertText(chunk);
+    ui->plainTextEdit->document()->setModified(false);
+    mIsAppendingText = false;
+
+    mLoadedSize = size;
+    mLoadedEncoding = encoding;
+    mLoadProgress->setValue(size > 0 ? int(bytesRead * 100 / size) : 100);
+
+    // Only the lines of the chunk are filtered, not the whole
+    // loaded part again
+    filterAppendedText();
+}
+
+void MainWindow::onLoadFinished()
+{
+    // Finished notification of a cancelled load may still be queued
+    // when the next load has already started
+    if (!mIsLoading || !mLoadWatcher.isFinished())
+    {
+        return;
+    }
+
+    // Chunks queued before the worker finished are already appended,
+    // they were posted before the finished notification
+    finishLoad();
+    setFollowFile();
+    showTimings(tr("Load"));
+}
+
+void MainWindow::finishLoad()
+{
+    mIsLoading = false;
+    mLoadProgress->setVisible(false);
+    ui->plainTextEdit->setReadOnly(false);
+    ui->plainTextEdit->document()->setUndoRedoEnabled(true);
+    ui->plainTextEdit->document()->setModified(false);
+    ui->plainTextEdit->setDirty(false);
+    updateSaveAndMenuButtonIcons();
+}
+
+void MainWindow::saveFile(const QString& filename)
+{
+    if (mIsLoading)
+    {
+        QMessageBox::information(
+            this,
+            tr("Unable to save file"),
+            tr("File is still loading."));
+        return;
+    }
+
+    ui->lineEditSearch->clear();
+
+    if (filename.isEmpty())
+    {
+        on_toolButtonSaveFileAs_clicked();
+        return;
+    }
+
+    // One save at a time, so they reach the disk in order
+    waitForSave();
+
+    mIsSaving = true;
+    mSavingFilename = filename;
+    mSaveEditRevision = mEditRevision;
+    mSaveDocumentGeneration = mDocumentGeneration;
+
+    // Replacing the file would look like log rotation to the follower,
+    // it follows the saved file again when the save is finished
+    mFollower.stop();
+
+    startTimings();
+
+    // Lines are copied a slice at a time, so a large file does not
+    // freeze the window. The editor is read-only until they are all
+    // copied, which is when the worker starts writing them.
+    ui->plainTextEdit->setReadOnly(true);
+    mSaveLines.clear();
+    mSaveLines.reserve(ui->plainTextEdit->document()->blockCount());
+    mSaveBlockNum = 0;
+    collectSaveLines();
+}
+
+void MainWindow::collectSaveLines()
+{
+    // Another file was opened or created, nothing is saved
+    if (mSaveDocumentGeneration != mDocumentGeneration)
+    {
+        mIsSaving = false;
+        mSaveLines.clear();
+        return;
+    }
+
+    {
+        Trace::Scope scope("editor.snapshot");
+        const qsizetype lineCount = mSaveLines.size();
+        QElapsedTimer slice;
+        slice.start();
+
+        QTextBlock block = ui->plainTextEdit->document()->findBlockByNumber(mSaveBlockNum);
+        for (int n = 1; block.isValid(); block = block.next(), ++n)
+        {
+            mSaveLines.append(block.text());
+            if (n % 1024 == 0 && slice.elapsed() >= kSaveSliceMs)
+            {
+                block = block.next();
+                break;
+            }
+        }
+        scope.setCounter("lines", mSaveLines.size() - lineCount);
+
+        if (block.isValid())
+        {
+            mSaveBlockNum = block.blockNumber();
+            mSaveSliceTimer.start();
+            return;
+        }
+    }
+
+    ui->plainTextEdit->setReadOnly(false);
+
+    // Worker only touches this copy, never the editor document
+    mSaveWatcher.setFuture(QtConcurrent::run(
+        [filename = mSavingFilename, lines = std::move(mSaveLines)]()
+        {
+            try
+            {
+                FileManager::save(filename, lines);
+            }
+            catch(const std::runtime_error& ex)
+            {
+                return QString::fromUtf8(ex.what());
+            }
+            return QString();
+        }));
+    mSaveLines.clear();
+}
+
+void MainWindow::waitForSave()
+{
+    while (mSaveSliceTimer.isActive())
+    {
+        mSaveSliceTimer.stop();
+        collectSaveLines();
+    }
+    mSaveWatcher.waitForFinished();
+    onSaveFinished();
+}
+
+void MainWindow::onSaveFinished()
+{
+    // Finished notification of a save which was waited for
+    // may still be queued when the next save has already started
+    if (!mIsSaving || mSaveSliceTimer.isActive() || !mSaveWatcher.isFinished())
+    {
+        return;
+    }
+    mIsSaving = false;
+
+    // Another file was opened or created meanwhile
+    const bool isSameDocument = mSaveDocumentGeneration == mDocumentGeneration;
+
+    const QString error = mSaveWatcher.result();
+    if (!error.isEmpty())
+    {
+        if (isSameDocument)
+        {
+            setFollowFile();
+        }
+        QMessageBox::information(this, tr("Unable to save file"), error);
+        return;
+    }
+
+    if (isSameDocument)
+    {
+        if (mSaveEditRevision == mEditRevision)
+        {
+            ui->plainTextEdit->setDirty(false);
+            ui->plainTextEdit->document()->setModified(false);
+        }
+        updateFilename(mSavingFilename);
+
+        // File now ends where the saved text does
+        mLoadedSize = QFileInfo(mSavingFilename).size();
+        mLoadedEncoding = TextCodec::Encoding::Utf8;
+        setFollowFile();
+    }
+
+    on_pushButtonMenu_clicked(false);
+    ui->frameInfo->setVisible(true);
+    QTimer::singleShot(2000, this, SLOT(hideFrameInfo()));
+    showTimings(tr("Save"));
+}
+
+void MainWindow::updateFilename(const QString &filename)
+{
+    Settings::getInstance().setFilename(filename);
+    Settings::getInstance().addRecentFile(filename);
+    setRecentFiles();
+    setWindowTitle(filename + " - Text Filter");
+    updateSaveAndMenuButtonIcons();
+}
+
+void MainWindow::hideFrameInfo()
+{
+    ui->frameInfo->setVisible(false);
+}
+
+void MainWindow::startTimings()
+{
+    mTimingsStart = Trace::now();
+}
+
+void MainWindow::showTimings(const QString& operation)
+{
+    if (Settings::getInstance().isShowTimings())
+    {
+        mTimingsOperation = operation;
+        mTimingsTimer.start();
+    }
+}
+
+void MainWindow::updateTimings()
+{
+    struct Stage
+    {
+        const char* name;
+        qint64 duration;
+        std::vector<std::pair<const char*, qint64>> counters;
+    };
+
+    // Events of the same stage are summed, e.g. every appended chunk
+    std::vector<Stage> stages;
+    qint64 end = mTimingsStart;
+    for (const Trace::Event& event : Trace::eventsSince(mTimingsStart))
+    {
+        end = std::max(end, event.start + event.duration);
+
+        // Chunks run in parallel, their sum is not the time of the scan
+        if (std::strcmp(event.name, "filter.scanChunk") == 0)
+        {
+            continue;
+        }
+
+        auto stage = std::find_if(stages.begin(), stages.end(), [&event](const Stage& s)
+        {
+            return std::strcmp(s.name, event.name) == 0;
+        });
+        if (stage == stages.end())
+        {
+            stages.push_back({event.name, 0, {}});
+            stage = stages.end() - 1;
+        }
+
+        stage->duration += event.duration;
+        for (const auto& counter : event.counters)
+        {
+            auto it = std::find_if(stage->counters.begin(), stage->counters.end(), [&counter](const auto& c)
+            {
+                return std::strcmp(c.first, counter.first) == 0;
+            });
+            if (it == stage->counters.end())
+            {
+                stage->counters.push_back(counter);
+            }
+            else
+            {
+                it->second += counter.second;
+            }
+        }
+    }
+
+    QLocale locale;
+    QStringList parts;
+    for (const Stage& stage : stages)
+    {
+        QStringList counters;
+        for (const auto& counter : stage.counters)
+        {
+            const bool isBytes = std::strcmp(counter.first, "bytes") == 0;
+            counters.append(QString("%1 %2").arg(
+                QLatin1String(counter.first),
+                isBytes ? locale.formattedDataSize(counter.second) : locale.toString(counter.second)));
+        }
+
+        QString part = QString("%1 %2 ms").arg(QLatin1String(stage.name)).arg(stage.duration / 1000.0, 0, 'f', 1);
+        if (!counters.isEmpty())
+        {
+            part += " (" + counters.join(", ") + ")";
+        }
+        parts.append(part);
+    }
+
+    mTimingsLabel->setText(QString("%1 %2 ms: %3")
+                               .arg(mTimingsOperation)
+                               .arg((end - mTimingsStart) / 1000.0, 0, 'f', 1)
+                               .arg(parts.join(" | ")));
+}
+
+void MainWindow::writeTrace()
+{
+    const QString filename = Settings::getInstance().getTraceFilename();
+    if (!Trace::writeChromeTrace(filename))
+    {
+        qWarning() << "MainWindow::writeTrace: failed to write" << filename;
+    }
+}
+
+void MainWindow::restoreScrollPosition()
+{
+    QTimer::singleShot(0, this, &MainWindow::applyRestoredScrollPosition);
+}
+
+void MainWindow::applyRestoredScrollPosition()
+{
+    // QPlainTextEdit's vertical scrollbar counts visual rows (wrapped lines),
+    // not blocks. documentLayout()->blockBoundingRect() returns zeros until
+    // blocks are painted, so we count visual rows by walking blocks directly.
+    int visualRow = 0;
+    QTextBlock block = ui->plainTextEdit->document()->begin();
+    while (block.isValid() && block.blockNumber() < mPreFilterTopBlock)
+    {
+        // lineCount() returns the number of visual rows this block occupies
+        // (> 1 when word wrap is on and the line is long)
+        visualRow += qMax(1, block.lineCount());
+        block = block.next();
+    }
+
+    ui->plainTextEdit->verticalScrollBar()->setValue(visualRow);
+    ui->plainTextEdit->horizontalScrollBar()->setValue(0);
+}
+
+void MainWindow::on_toolButtonPrevious_clicked()
+{
+    if (rootDocument == nullptr)
+    {
+        return;
+    }
+
+    startTimings();
+    rootDocument->highlightPrevLine();
+    showCurrentMatch();
+    showTimings(tr("Navigation"));
+}
+
+void MainWindow::on_toolButtonNext_clicked()
+{
+    if (rootDocument == nullptr)
+    {
+        return;
+    }
+
+    startTimings();
+    rootDocument->highlightNextLine();
+    showCurrentMatch();
+    showTimings(tr("Navigation"));
+}
+
+void MainWindow::on_toolButtonOpenFile_clicked()
+{
+    QString filename =
+        QFileDialog::getOpenFileName(
+            this,
+            tr("Open File"), "",
+            tr("Text File (*.txt);;All Files (*)"));
+
+    loadFile(filename);
+}
+
+void MainWindow::on_toolButtonSaveFile_clicked()
+{
+    QString filename = Settings::getInstance().getFilename();
+    saveFile(filename);
+}
+
+void MainWindow::on_toolButtonSaveFileAs_clicked()
+{
+    QString filename =
+        QFileDialog::getSaveFileName(
+            this,
+            tr("Save File"), "",
+            tr("Text File (*.txt);;All Files (*)"));
+
+    if (!filename.isEmpty())
+    {
+        saveFile(filename);
+    }
+}
+
+void MainWindow::clearFilter()
+{
+    // Save the top visible block number before clear() triggers textChanged("")
+    // which hides the filter view.
+    // Filter view shows line numbers of the full document, so its top line
+    // is where the full document is scrolled to.
+    const int filterViewTopLine = ui->filterView->firstVisibleLineNum();
+    mPreFilterTopBlock =
+        ui->filterView->isVisible() && filterViewTopLine != -1
+            ? filterViewTopLine
+            : ui->plainTextEdit->firstVisibleBlock().blockNumber();
+    ui->lineEditSearch->clear();
+    ui->lineEditSearch->setFocus();
+}
+
+void MainWindow::on_toolButtonCopyLine_clicked()
+{
+    if (ui->filterView->isVisible())
+    {
+        ui->filterView->copyCurrentLine();
+        return;
+    }
+
+    QTextCursor cursor(ui->plainTextEdit->textCursor());
+    cursor.movePosition(QTextCursor::EndOfBlock);
+    cursor.movePosition(QTextCursor::StartOfBlock, QTextCursor::KeepAnchor);
+    ui->plainTextEdit->setTextCursor(cursor);
+    ui->plainTextEdit->copy();
+}
+
+void MainWindow::on_toolButtonCopyMultipleLines_clicked()
+{
+    if (ui->filterView->isVisible())
+    {
+        ui->filterView->copySelectedLines();
+        return;
+    }
+
+    QTextCursor cursor = ui->plainTextEdit->textCursor();
+    if (cursor.hasSelection())
+    {
+        int start = cursor.selectionStart();
+        int end = cursor.selectionEnd();
+
+        // Check if selection begins from beginning of line
+        cursor.setPosition(start);
+        cursor.movePosition(QTextCursor::StartOfLine);
+        if (start == cursor.position())
+        {
+            // Continue selecting text
+            cursor.setPosition(end, QTextCursor::KeepAnchor);
+            cursor.movePosition(QTextCursor::Down, QTextCursor::KeepAnchor);
+            cursor.movePosition(QTextCursor::StartOfLine, QTextCursor::KeepAnchor);
+            ui->plainTextEdit->setTextCursor(cursor);
+            ui->plainTextEdit->copy();
+            return;
+        }
+        else
+        {
+            // If selections begins in the middle of the line
+            // ignore selection and copy current line
+            cursor.setPosition(end);
+        }
+    }
+
+    cursor.movePosition(QTextCursor::StartOfLine);
+    cursor.movePosition(QTextCursor::Down, QTextCursor::KeepAnchor);
+    cursor.movePosition(QTextCursor::StartOfLine, QTextCursor::KeepAnchor);
+    ui->plainTextEdit->setTextCursor(cursor);
+    ui->plainTextEdit->copy();
+}
+
+void MainWindow::on_toolButtonAlwaysOnTop_clicked()
+{
+    Settings::getInstance().setAlwaysOnTop(!Settings::getInstance().isAlwaysOnTop());
+    setAlwaysOnTop();
+}
+
+void MainWindow::on_toolButtonSettings_clicked()
+{
+    SettingsWindow settingsWindow;
+    settingsWindow.setModal(true);
+
+    connect(&settingsWindow, &SettingsWindow::applySettings,
+            this, &MainWindow::applySettings);
+
+    Qt::WindowFlags flags = settingsWindow.windowFlags();
+    flags = flags & ~Qt::WindowContextHelpButtonHint; // Hide help ? button
+    if (Settings::getInstance().isAlwaysOnTop())
+    {
+        flags = flags | Qt::WindowStaysOnTopHint;
+    }
+    else
+    {
+        flags = flags & ~Qt::WindowStaysOnTopHint;
+    }
+    settingsWindow.setWindowFlags(flags);
+    settingsWindow.exec();
+}
+
+void MainWindow::on_toolButtonHelp_clicked()
+{
+    QMessageBox::information(
+        this,
+        tr("Text Filter"),
+        tr("Text Filter v1.7\n"
+           "\n"
+           " * Use fuzzy match to filter text (e.g. 'ore psu' will find 'Lorem Ipsum').\n"
+           " * Press Enter in the Filter field to go to the next filter result.\n"
+           " * Use Ctrl+Left Mouse Click on the line, to copy whole line to clipboard.\n"
+           " * Press Alt+C several times to extend selection and copy multiple lines to clipboard.\n"
+           "\n"
+           "Icons are taken from sites:\n"
+           "- http://www.iconarchive.com\n"
+           "- http://www.iconsmind.com\n"
+           "- http://icons8.com\n"
+           "\n"
+           "Written by Stepan Sypliak using Qt Creator."),
+        QMessageBox::Ok);
+}
+
+void MainWindow::on_toolButtonWordWrap_clicked()
+{
+    Settings::getInstance().setWordWrap(!Settings::getInstance().isWordWrap());
+    setWordWrap();
+}
+
+void MainWindow::on_toolButtonFollow_clicked()
+{
+    Settings::getInstance().setFollowFile(!Settings::getInstance().isFollowFile());
+    setFollowFile();
+}
+
+void MainWindow::on_pushButtonMenu_clicked(bool checked)
+{
+    // Shortcuts does not work when control is not visible
+    ui->widgetMenu->setMinimumSize(0, checked ? 40 : 0);
+    ui->widgetMenu->setMaximumSize(16777215, checked ? 40 : 0);
+    ui->pushButtonMenu->setChecked(checked);
+}
+
+void MainWindow::on_toolButtonNewFile_clicked()
+{
+    cancelLoad();
+    mFollower.stop();
+    ++mDocumentGeneration;
+    ui->plainTextEdit->clear();
+    ui->lineEditSearch->clear();
+    mTrigramIndex.reset();
+    Settings::getInstance().setFilename("");
+    setFollowFile();
+    setWindowTitle("Untitled - Text Filter");
+}
+
+void MainWindow::on_plainTextEdit_textChanged()
+{
+    ++mEditRevision;
+
+    // Loaded and followed text keeps the filter up to date by itself
+    if (mIsAppendingText)
+    {
+        return;
+    }
+
+    // Filtering never writes into the editor, so its document
+    // is always the one which is saved.
+    // Appending a loaded chunk does not make the text dirty.
+    if (!mIsLoading)
+    {
+        ui->plainTextEdit->setDirty(ui->plainTextEdit->document()->isModified());
+        updateSaveAndMenuButtonIcons();
+    }
+
+    // Filtered snapshot no longer matches the editor
+    if (rootDocument != nullptr)
+    {
+        ui->plainTextEdit->clearCurrentMatch();
+        mRefilterTimer.start();
+    }
+}
+
+void MainWindow::setRecentFiles()
+{
+    for (auto* action : ui->toolButtonOpenFile->actions())
+    {
+        ui->toolButtonOpenFile->removeAction(action);
+        delete action;
+    }
+
+    const QStringList recentFiles = Settings::getInstance().getRecentFiles();
+    for (const QString& filename : recentFiles)
+    {
+        QAction* recentFile = new QAction(filename, this);
+        QObject::connect(recentFile, SIGNAL(triggered()), this, SLOT(openRecent()));
+        ui->toolButtonOpenFile->addAction(recentFile);
+    }
+}
+
+void MainWindow::openRecent()
+{
+    QAction* action = qobject_cast<QAction *>(sender());
+    loadFile(action->text());
+}
+
+void MainWindow::updateSaveAndMenuButtonIcons()
+{
+    const bool dirty = ui->plainTextEdit->isDirty();
+
+    // Guard: skip entirely if the dirty state hasn't changed since the last
+    // call. This is what prevents setIcon() (and previously, QIcon
+    // construction) from running on every single keystroke — only the
+    // keystroke that actually flips clean<->dirty does any work.
+    const int dirtyState = dirty ? 1 : 0;
+    if (dirtyState == mLastDirtyState)
+    {
+        return;
+    }
+    mLastDirtyState = dirtyState;
+
+    ui->pushButtonMenu->setIcon    (dirty ? mIconMenuChanged : mIconMenuClean);
+    ui->toolButtonSaveFile->setIcon(dirty ? mIconSaveChanged : mIconSaveClean);
+}
+
+void MainWindow::setIconMultipleResolutions(QAbstractButton *button, const QString& iconName)
+{
+    QIcon icon(":/resources/128x128/" + iconName);
+    button->setIcon(icon);
+}
+
+bool MainWindow::eventFilter(QObject *obj, QEvent *event)
+{
+    if (obj == ui->lineEditSearch && event->type() == QEvent::KeyPress)
+    {
+        QKeyEvent *keyEvent = static_cast<QKeyEvent*>(event);
+        if (keyEvent->key() == Qt::Key_Escape)
+        {
+            clearFilter();
+            return true; // Mark event as handled (intercepted)
+        }
+        else if (keyEvent->key() == Qt::Key_Return || keyEvent->key() == Qt::Key_Enter)
+        {
+            if (keyEvent->modifiers() & Qt::ShiftModifier)
+            {
+                on_toolButtonPrevious_clicked();
+            }
+            else
+            {
+                on_toolButtonNext_clicked();
+            }
+            return true;
+        }
+    }
+    // Pass unhandled events to the parent class hierarchy
+    return QMainWindow::eventFilter(obj, event);
+}
\ No newline at end of file
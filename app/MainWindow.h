@@ -0,0 +1,232 @@
+#ifndef MAINWINDOW_H
+#define MAINWINDOW_H
+
+#include "Document.h"
+#include "FileFollower.h"
+
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QIcon>
+#include <QMainWindow>
+#include <QSemaphore>
+#include <QTimer>
+#include <QtWidgets/QAbstractButton>
+#include <atomic>
+
+class QLabel;
+class QProgressBar;
+
+namespace Ui {
+class MainWindow;
+}
+
+class MainWindow : public QMainWindow
+{
+    Q_OBJECT
+
+public:
+    explicit MainWindow(QWidget *parent = 0);
+    ~MainWindow();
+
+public slots:
+protected:
+    void closeEvent(QCloseEvent *event);
+    bool eventFilter(QObject *obj, QEvent *event);
+private slots:
+    void on_lineEditSearch_textChanged(const QString &text);
+    void on_toolButtonPrevious_clicked();
+    void on_toolButtonNext_clicked();
+    void on_toolButtonOpenFile_clicked();
+    void on_toolButtonSaveFile_clicked();
+    void on_toolButtonSaveFileAs_clicked();
+    void clearFilter();
+    void on_toolButtonCopyLine_clicked();
+    void on_toolButtonCopyMultipleLines_clicked();
+    void on_toolButtonAlwaysOnTop_clicked();
+    void on_toolButtonSettings_clicked();
+    void on_toolButtonHelp_clicked();
+    void on_toolButtonWordWrap_clicked();
+    void on_toolButtonFollow_clicked();
+    void on_toolButtonNewFile_clicked();
+    void on_pushButtonMenu_clicked(bool checked);
+
+    void hideFrameInfo();
+    void openRecent();
+    void restoreScrollPosition();
+    void applyRestoredScrollPosition();
+
+    void on_plainTextEdit_textChanged();
+
+    void onFilterFinished();
+    void startDelayedFilter();
+    void showLineInEditor(int lineNum);
+
+    void onLoadFinished();
+    void onSaveFinished();
+    void appendFollowedText(const QString& text);
+    void onFollowedFileReset();
+    void updateTimings();
+
+private:
+    void applySettings();
+    void createMenuActions();
+    void saveFile(const QString& filename);
+    void loadFile(const QString& fileName);
+    void setAlwaysOnTop();
+    void setWordWrap();
+    void setFollowFile();
+    void collectSaveLines();
+    void waitForSave();
+    void loadLastFile();
+
+    Ui::MainWindow *ui;
+    void setRecentFiles();
+    void updateSaveAndMenuButtonIcons();
+    void updateFilename(const QString& filename);
+    void setIconMultipleResolutions(
+        QAbstractButton *button,
+        const QString &iconName);
+
+    void scheduleFilter(const QString& filter);
+    void startFilter(const QString& filter);
+    double filterCostMs() const;
+    void updateFilterCost(qint64 elapsedMs, bool isCancelled);
+    void refilterEditedText();
+    void filterAppendedText();
+    void appendPendingText();
+    void startLoad(const QString& filename);
+    void cancelLoad();
+    void finishLoad();
+    void appendLoadedChunk(
+        int generation,
+        const QString& chunk,
+        qint64 bytesRead,
+        qint64 size,
+        TextCodec::Encoding encoding);
+    void updateNavigationButtons();
+    void showFilterView(bool visible);
+    void showCurrentMatch();
+    void startTimings();
+    void showTimings(const QString& operation);
+    void writeTrace();
+
+    std::shared_ptr<Document> rootDocument;
+
+    // Index of the last filter session, reused by the next one
+    std::shared_ptr<const TrigramIndex> mTrigramIndex;
+    int mPreFilterTopBlock;
+
+    // Filtering runs on a worker thread, one pass at a time.
+    // Every change of the filter text bumps the generation, so a pass
+    // started for older text stops early and its result is discarded.
+    // The newest filter waits in mPendingFilter until the pass is done.
+    // A pass is running from startFilter() until onFilterFinished().
+    QFutureWatcher<std::shared_ptr<const Document::FilterResult>> mFilterWatcher;
+    std::atomic<int> mFilterGeneration;
+    int mRunningFilterGeneration;
+    QString mRunningFilter;
+    QString mPendingFilter;
+    bool mHasPendingFilter;
+    bool mIsFilterRunning;
+
+    // Keystrokes are filtered at once while passes are cheap. Once they
+    // get expensive, keystrokes are coalesced for about as long as a pass
+    // takes, but never longer than kMaxFilterDelayMs after the first one,
+    // and the latest filter text is the one filtered.
+    // Cost is a moving average of recent passes per character of text,
+    // so it holds for a text of another size, and is kept across loads.
+    QTimer mFilterDelayTimer;
+    QElapsedTimer mFilterDelayStart;
+    QElapsedTimer mFilterPassTimer;
+    QString mDelayedFilter;
+    double mFilterCostPerChar;
+    static constexpr int kCheapFilterMs = 30;
+    static constexpr int kMaxFilterDelayMs = 250;
+
+    // Filtered text is a snapshot of the editor. When the editor is
+    // edited while a filter is active, a new snapshot is filtered
+    // once typing pauses. The editor stays on screen meanwhile.
+    QTimer mRefilterTimer;
+    bool mIsRefilterAfterEdit;
+    static constexpr int kRefilterDelayMs = 300;
+
+    // Files are read on a worker thread and appended to the editor
+    // chunk by chunk. Starting another load bumps the generation,
+    // so the running one stops and its queued chunks are dropped.
+    // The worker waits while kMaxPendingLoadChunks chunks are queued,
+    // so a slow editor does not make it buffer the whole file. Every
+    // queued chunk holds a slot until it is appended, cancelling
+    // the load releases one to wake the worker.
+    // With a filter active, only the lines of each chunk are filtered.
+    QFutureWatcher<void> mLoadWatcher;
+    std::atomic<int> mLoadGeneration;
+    QSemaphore mLoadChunkSlots;
+    bool mIsLoading;
+    QProgressBar* mLoadProgress;
+    static constexpr int kMaxPendingLoadChunks = 2;
+
+    // Size of the file when it was loaded, following starts there.
+    // Followed bytes are decoded in the encoding it was loaded with.
+    qint64 mLoadedSize;
+    TextCodec::Encoding mLoadedEncoding;
+
+    // Appends lines written to the open file while follow mode is on.
+    // The editor is read-only meanwhile, so it mirrors the file.
+    // Text followed while a filter pass runs is appended to the
+    // filtered document once the pass is finished, same as loaded chunks.
+    FileFollower mFollower;
+    bool mIsAppendingText;
+    bool mHasPendingAppend;
+
+    // Files are saved on a worker thread from a snapshot of the text.
+    // The snapshot is copied from the editor kSaveSliceMs at a time,
+    // the editor is read-only until it is complete and usable after:
+    // text is marked clean only if it was not edited since the snapshot,
+    // and the saved file name is applied only if the same document
+    // is still open.
+    QFutureWatcher<QString> mSaveWatcher;
+    QTimer mSaveSliceTimer;
+    QStringList mSaveLines;
+    int mSaveBlockNum;
+    static constexpr int kSaveSliceMs = 10;
+    bool mIsSaving;
+    QString mSavingFilename;
+    int mEditRevision;
+    int mSaveEditRevision;
+    int mDocumentGeneration;
+    int mSaveDocumentGeneration;
+
+    // Stages of the last filter, navigation, load or save, from the
+    // trace events recorded since it started. They are shown a moment
+    // after it is finished, so painting the result is included.
+    QLabel* mTimingsLabel;
+    QTimer mTimingsTimer;
+    qint64 mTimingsStart;
+    QString mTimingsOperation;
+    bool mIsRecordingTrace;
+    static constexpr int kTimingsDelayMs = 100;
+
+    // Shown when a filter pass takes longer than kFilterBusyDelayMs
+    QProgressBar* mFilterBusyIndicator;
+    QTimer mFilterBusyTimer;
+    static constexpr int kFilterBusyDelayMs = 150;
+
+    // Icon cache: loaded once (see MainWindow ctor) instead of constructing
+    // a new QIcon from the resource path on every call to
+    // updateSaveAndMenuButtonIcons (which previously fired on every
+    // keystroke via on_plainTextEdit_textChanged).
+    QIcon mIconMenuClean;
+    QIcon mIconMenuChanged;
+    QIcon mIconSaveClean;
+    QIcon mIconSaveChanged;
+
+    // Tracks whether the icons are currently showing the "dirty" state.
+    // updateSaveAndMenuButtonIcons() is a no-op when this already matches
+    // the editor's actual dirty state, so setIcon() is only called on the
+    // keystroke where the dirty flag actually flips, not on every keystroke.
+    // Starts as an impossible/uninitialized-marker value so the very first
+    // call always performs the initial icon assignment.
+    int mLastDirtyState = -1; // -1 = not yet set, 0 = clean, 1 = dirty
+};
+
+#endif // MAINWINDOW_H
\ No newline at end of file
@@ -0,0 +1,388 @@
+#include "PlainTextEdit.h"
+#include "Trace.h"
+#include <QDebug>
+#include <QApplication>
+#include <QTextCursor>
+#include <QTextBlock>
+#include <QScrollBar>
+#include <Settings.h>
+#include <QMessageBox>
+#include <QPainter>
+#include <QTextLayout>
+#include <algorithm>
+#include <cmath>
+
+PlainTextEdit::PlainTextEdit(QWidget *parent)
+    : QPlainTextEdit(parent)
+    , mIsDirty(false)
+{
+    lineNumberArea = new LineNumberArea(this);
+
+    connect(
+        this,
+        SIGNAL(blockCountChanged(int)),
+        this,
+        SLOT(updateLineNumberAreaWidth(int)));
+
+    connect(
+        this,
+        SIGNAL(updateRequest(QRect,int)),
+        this,
+        SLOT(updateLineNumberArea(QRect,int)));
+
+    connect(
+        document(),
+        &QTextDocument::contentsChange,
+        this,
+        &PlainTextEdit::updateTextBuffer);
+
+    updateLineNumberAreaWidth(0);
+    rebuildTextBuffer();
+}
+
+void PlainTextEdit::mousePressEvent(QMouseEvent *event)
+{
+
+    if (event->button() == Qt::LeftButton
+        && QApplication::keyboardModifiers().testFlag(Qt::ControlModifier))
+    {
+        int line =
+            event->pos().y() / fontMetrics().height()
+            + verticalScrollBar()->value();
+
+        QTextCursor cursor(document()->findBlockByLineNumber(line));
+        cursor.movePosition(QTextCursor::EndOfBlock);
+        cursor.movePosition(QTextCursor::StartOfBlock, QTextCursor::KeepAnchor);
+        setTextCursor(cursor);
+        copy();
+        return;
+    }
+
+    QPlainTextEdit::mousePressEvent(event);
+}
+
+void PlainTextEdit::wheelEvent(QWheelEvent *event)
+{
+
+    if (QApplication::keyboardModifiers().testFlag(Qt::ControlModifier))
+    {
+        int zoomLevel = 1;
+        if (font().pointSize() > 45)
+        {
+            zoomLevel = 8;
+        }
+        else if (font().pointSize() > 25)
+        {
+            zoomLevel = 4;
+        }
+        else if (font().pointSize() > 12)
+        {
+            zoomLevel = 2;
+        }
+
+        if(event->angleDelta().y() > 0)
+        {
+            zoomIn(zoomLevel);
+        }
+        else
+        {
+            zoomOut(zoomLevel);
+        }
+        Settings::getInstance().setFont(font());
+        updateTabWidth();
+        return;
+    }
+
+    QPlainTextEdit::wheelEvent(event);
+}
+
+void PlainTextEdit::setPlainText(const QString &text)
+{
+    QPlainTextEdit::setPlainText(text);
+    document()->setModified(false);
+    mIsDirty = false;
+    rebuildTextBuffer();
+}
+
+
+
+int PlainTextEdit::lineNumberAreaWidth()
+{
+
+    int digits = 1;
+    int max = qMax(1, blockCount());
+    while (max >= 10)
+    {
+        max /= 10;
+        ++digits;
+    }
+
+    int space = 8 + fontMetrics().horizontalAdvance(QLatin1Char('9')) * digits;
+
+    return space;
+}
+
+void PlainTextEdit::updateLineNumberAreaWidth(int /* newBlockCount */)
+{
+    setViewportMargins(lineNumberAreaWidth(), 0, 0, 0);
+}
+
+void PlainTextEdit::updateLineNumberArea(const QRect &rect, int dy)
+{
+    if (dy)
+    {
+        lineNumberArea->scroll(0, dy);
+    }
+    else
+    {
+        lineNumberArea->update(
+            0,
+            rect.y(),
+            lineNumberArea->width(),
+            rect.height());
+    }
+
+    if (rect.contains(viewport()->rect()))
+    {
+        updateLineNumberAreaWidth(0);
+    }
+}
+
+void PlainTextEdit::resizeEvent(QResizeEvent *e)
+{
+    QPlainTextEdit::resizeEvent(e);
+
+    QRect cr = contentsRect();
+    lineNumberArea->setGeometry(
+        QRect(cr.left(), cr.top(), lineNumberAreaWidth(), cr.height()));
+}
+
+void PlainTextEdit::lineNumberAreaPaintEvent(QPaintEvent *event)
+{
+    // qDebug() << Q_FUNC_INFO << __LINE__ << ": verticalScrollBar =" << verticalScrollBar()->value();
+
+    QPainter painter(lineNumberArea);
+    painter.fillRect(event->rect(), QColor(233,233,233));
+
+    QTextBlock block = firstVisibleBlock();
+    int blockNumber = block.blockNumber();
+
+    int top =
+        (int)blockBoundingGeometry(block)
+            .translated(contentOffset()).top();
+
+    int bottom = top + (int) blockBoundingRect(block).height();
+
+    while (block.isValid() && top <= event->rect().bottom())
+    {
+        if (block.isVisible() && bottom >= event->rect().top())
+        {
+            QString number = QString::number(blockNumber + 1);
+            painter.setPen(QColor(140,140,140));
+            painter.drawText(
+                0,
+                top,
+                lineNumberArea->width()-5,
+                fontMetrics().height(),
+                Qt::AlignRight, number);
+        }
+
+        block = block.next();
+        top = bottom;
+        bottom = top + (int) blockBoundingRect(block).height();
+        ++blockNumber;
+    }
+}
+
+void PlainTextEdit::setCurrentMatch(
+    int lineNum,
+    const HighlightArea* begin,
+    const HighlightArea* end)
+{
+    QList<QTextEdit::ExtraSelection> selections;
+
+    QTextBlock block = document()->findBlockByNumber(lineNum);
+    if (block.isValid())
+    {
+        QTextEdit::ExtraSelection line;
+        line.format.setBackground(QColor(233,233,233));
+        line.format.setProperty(QTextFormat::FullWidthSelection, true);
+        line.cursor = QTextCursor(block);
+        selections.append(line);
+
+        for (auto area = begin; area != end; ++area)
+        {
+            QTextEdit::ExtraSelection match;
+            match.format.setBackground(Qt::green);
+            match.cursor = QTextCursor(block);
+            match.cursor.setPosition(block.position() + area->begin);
+            match.cursor.setPosition(block.position() + area->end, QTextCursor::KeepAnchor);
+            selections.append(match);
+        }
+    }
+
+    setExtraSelections(selections);
+}
+
+void PlainTextEdit::clearCurrentMatch()
+{
+    setExtraSelections({});
+}
+
+void PlainTextEdit::setMatches(std::shared_ptr<const MatchList> matches)
+{
+    mMatches = std::move(matches);
+    viewport()->update();
+}
+
+std::shared_ptr<const TextBuffer> PlainTextEdit::textBuffer() const
+{
+    // Shares the segments, the next change copies the ones it touches
+    return std::make_shared<const TextBuffer>(*mText);
+}
+
+void PlainTextEdit::updateTextBuffer(int position, int charsRemoved, int charsAdded)
+{
+    // Blocks from the one at position to the one at the end of the
+    // added text replace the lines the change removed. How many lines
+    // that is follows from the change of the block count.
+    QTextBlock first = document()->findBlock(position);
+    QTextBlock last = document()->findBlock(position + charsAdded);
+    if (!first.isValid())
+    {
+        first = document()->lastBlock();
+    }
+    if (!last.isValid())
+    {
+        last = document()->lastBlock();
+    }
+
+    const int firstLine = first.blockNumber();
+    const int addedCount = last.blockNumber() - firstLine + 1;
+    const int removedCount = addedCount - (document()->blockCount() - mText->lineCount());
+    if (removedCount < 0 || firstLine + removedCount > mText->lineCount())
+    {
+        rebuildTextBuffer();
+        return;
+    }
+
+    Trace::Scope scope("text.fold");
+    scope.setCounter("lines", addedCount);
+
+    // Text added at the very end is appended, which keeps the revision,
+    // so the filter result is extended instead of found again
+    const bool isAppend = charsRemoved == 0
+        && removedCount == 1
+        && firstLine == mText->lineCount() - 1
+        && position == first.position() + mText->foldedLine(firstLine).size();
+    if (isAppend)
+    {
+        mText->appendToLastLine(QStringView(first.text()).mid(position - first.position()));
+        for (QTextBlock block = first; block != last && block.isValid();)
+        {
+            block = block.next();
+            mText->appendLine(block.text());
+        }
+        return;
+    }
+
+    QStringList lines;
+    lines.reserve(addedCount);
+    for (QTextBlock block = first; block.isValid(); block = block.next())
+    {
+        lines.append(block.text());
+        if (block == last)
+        {
+            break;
+        }
+    }
+    mText->replaceLines(firstLine, removedCount, lines);
+}
+
+void PlainTextEdit::rebuildTextBuffer()
+{
+    Trace::Scope scope("text.fold");
+    scope.setCounter("lines", document()->blockCount());
+
+    mText = std::make_shared<TextBuffer>();
+    for (QTextBlock block = document()->begin(); block.isValid(); block = block.next())
+    {
+        mText->appendLine(block.text());
+    }
+}
+
+void PlainTextEdit::paintEvent(QPaintEvent *event)
+{
+    if (mMatches != nullptr && !mMatches->isEmpty())
+    {
+        paintMatches(event->rect());
+    }
+
+    QPlainTextEdit::paintEvent(event);
+}
+
+void PlainTextEdit::paintMatches(const QRect& rect)
+{
+    QPainter painter(viewport());
+    painter.setClipRect(rect);
+
+    QTextBlock block = firstVisibleBlock();
+
+    // First match at or below the top of the viewport
+    int n = mMatches->nextIndex(block.blockNumber() - 1);
+
+    while (block.isValid() && n < mMatches->size())
+    {
+        const QRectF blockRect = blockBoundingGeometry(block).translated(contentOffset());
+        if (blockRect.top() > rect.bottom())
+        {
+            break;
+        }
+
+        if (mMatches->lineAt(n) == block.blockNumber())
+        {
+            const QTextLayout* layout = block.layout();
+            const QPointF origin = blockRect.topLeft() + layout->position();
+            const int blockLength = block.length() - 1;
+
+            for (auto area = mMatches->areaBegin(n); area != mMatches->areaEnd(n); ++area)
+            {
+                // An area can span several lines when word wrap is on
+                int begin = std::min(area->begin, blockLength);
+                const int end = std::min(area->end, blockLength);
+                while (begin < end)
+                {
+                    const QTextLine line = layout->lineForTextPosition(begin);
+                    if (!line.isValid())
+                    {
+                        break;
+                    }
+
+                    const int lineEnd = std::min(end, line.textStart() + line.textLength());
+                    const qreal x1 = line.cursorToX(begin);
+                    const qreal x2 = line.cursorToX(lineEnd);
+                    painter.fillRect(
+                        QRectF(origin.x() + std::min(x1, x2),
+                               origin.y() + line.y(),
+                               std::abs(x2 - x1),
+                               line.height()),
+                        Qt::yellow);
+
+                    if (lineEnd <= begin)
+                    {
+                        break;
+                    }
+                    begin = lineEnd;
+                }
+            }
+            ++n;
+        }
+
+        block = block.next();
+    }
+}
+
+void PlainTextEdit::updateTabWidth()
+{
+    setTabStopDistance(QFontMetricsF(font()).horizontalAdvance(' ') * 4);
+}
\ No newline at end of file
@@ -1,6 +1,8 @@
 #ifndef PLAINTEXTEDIT_H
 #define PLAINTEXTEDIT_H
 
+#include "MatchList.h"
+#include "TextBuffer.h"
 #include "qtextobject.h"
 #include <QPlainTextEdit>
 #include <memory>
@@ -14,7 +16,24 @@ public:
     explicit PlainTextEdit(QWidget *parent = Q_NULLPTR);
 
     void setPlainText(const QString &text);
-    void setTextFromOtherDocument(std::shared_ptr<QTextDocument> otherDocument);
+
+    // Highlight the line and its matched areas on top of the text.
+    // Only the overlay changes, the document is not touched.
+    void setCurrentMatch(
+        int lineNum,
+        const HighlightArea* begin,
+        const HighlightArea* end);
+    void clearCurrentMatch();
+
+    // Matched areas to highlight, nullptr for none.
+    // They are painted under the text of visible lines only,
+    // the document is not touched.
+    void setMatches(std::shared_ptr<const MatchList> matches);
+
+    // Snapshot of the text to filter, one line per block.
+    // The buffer follows every change of the document, so taking
+    // a snapshot does not read the document again.
+    std::shared_ptr<const TextBuffer> textBuffer() const;
 
     // LineNumberArea
     void lineNumberAreaPaintEvent(QPaintEvent *event);
@@ -31,6 +50,7 @@ public:
 
 protected:
 
+    void paintEvent(QPaintEvent *event) override;
     void mousePressEvent(QMouseEvent *event) override;
     void wheelEvent(QWheelEvent *event) override;
     void resizeEvent(QResizeEvent *event) override;
@@ -39,10 +59,17 @@ private slots:
 
     void updateLineNumberAreaWidth(int newBlockCount);
     void updateLineNumberArea(const QRect &, int);
+    void updateTextBuffer(int position, int charsRemoved, int charsAdded);
 
 private:
+
+    void paintMatches(const QRect& rect);
+    void rebuildTextBuffer();
+
     QWidget *lineNumberArea;
     bool mIsDirty;
+    std::shared_ptr<const MatchList> mMatches;
+    std::shared_ptr<TextBuffer> mText;
 };
 
 
@@ -1,6 +1,7 @@
 #include "Settings.h"
 #include <QApplication>
 #include <QDebug>
+#include <QFileInfo>
 #include <QSettings>
 #include <QStandardPaths>
 
@@ -12,7 +13,13 @@ static const QString cFontBold        = QStringLiteral("FONT_BOLD");
 static const QString cGeometry        = QStringLiteral("GEOMETRY");
 static const QString cAlwaysOnTop     = QStringLiteral("ALWAYS_ON_TOP");
 static const QString cFilterThreshold = QStringLiteral("FILTER_THRESHOLD");
+static const QString cFilterThreads   = QStringLiteral("FILTER_THREADS");
+static const QString cIndexLargeFiles = QStringLiteral("INDEX_LARGE_FILES");
+static const QString cResultCacheSize = QStringLiteral("RESULT_CACHE_SIZE");
 static const QString cWordWrap        = QStringLiteral("WORD_WRAP");
+static const QString cFollowFile      = QStringLiteral("FOLLOW_FILE");
+static const QString cShowTimings     = QStringLiteral("SHOW_TIMINGS");
+static const QString cRecordTrace     = QStringLiteral("RECORD_TRACE");
 static const QString cRecentFiles     = QStringLiteral("RECENT_FILES");
 static const QString cStyleStrategy   = QStringLiteral("STYLE_STRATEGY");
 
@@ -29,7 +36,13 @@ Settings::Settings()
     mGeometry        = settings.value(cGeometry, QByteArray{}).toByteArray();
     mAlwaysOnTop     = settings.value(cAlwaysOnTop, true).toBool();
     mFilterThreshold = settings.value(cFilterThreshold, 1).toInt();
+    mFilterThreads   = settings.value(cFilterThreads, 0).toInt();
+    mIndexLargeFiles = settings.value(cIndexLargeFiles, true).toBool();
+    mResultCacheSize = settings.value(cResultCacheSize, 64).toInt();
     mWordWrap        = settings.value(cWordWrap, false).toBool();
+    mFollowFile      = settings.value(cFollowFile, false).toBool();
+    mShowTimings     = settings.value(cShowTimings, false).toBool();
+    mRecordTrace     = settings.value(cRecordTrace, false).toBool();
     mStyleStrategy   = static_cast<QFont::StyleStrategy>(
         settings.value(cStyleStrategy, QFont::PreferDefault).toInt());
 
@@ -70,11 +83,22 @@ void Settings::flushToDisk()
     settings.setValue(cGeometry,        mGeometry);
     settings.setValue(cAlwaysOnTop,     mAlwaysOnTop);
     settings.setValue(cFilterThreshold, mFilterThreshold);
+    settings.setValue(cFilterThreads,   mFilterThreads);
+    settings.setValue(cIndexLargeFiles, mIndexLargeFiles);
+    settings.setValue(cResultCacheSize, mResultCacheSize);
     settings.setValue(cWordWrap,        mWordWrap);
+    settings.setValue(cFollowFile,      mFollowFile);
+    settings.setValue(cShowTimings,     mShowTimings);
+    settings.setValue(cRecordTrace,     mRecordTrace);
     settings.setValue(cStyleStrategy,   static_cast<int>(mStyleStrategy));
     settings.setValue(cRecentFiles,     mRecentFiles);
 }
 
+QString Settings::getTraceFilename() const
+{
+    return QFileInfo(mIniPath).absolutePath() + QStringLiteral("/TextFilter-trace.json");
+}
+
 // Called from MainWindow::closeEvent to guarantee the final state is written
 // before the process exits, even if the debounce timer has not fired yet.
 void Settings::flushNow()
@@ -115,12 +139,48 @@ void Settings::setFilterThreshold(int filterThreshold)
     scheduleSave();
 }
 
+void Settings::setFilterThreads(int filterThreads)
+{
+    mFilterThreads = filterThreads;
+    scheduleSave();
+}
+
+void Settings::setIndexLargeFiles(bool indexLargeFiles)
+{
+    mIndexLargeFiles = indexLargeFiles;
+    scheduleSave();
+}
+
+void Settings::setResultCacheSize(int resultCacheSize)
+{
+    mResultCacheSize = resultCacheSize;
+    scheduleSave();
+}
+
 void Settings::setWordWrap(bool wordWrap)
 {
     mWordWrap = wordWrap;
     scheduleSave();
 }
 
+void Settings::setFollowFile(bool followFile)
+{
+    mFollowFile = followFile;
+    scheduleSave();
+}
+
+void Settings::setShowTimings(bool showTimings)
+{
+    mShowTimings = showTimings;
+    scheduleSave();
+}
+
+void Settings::setRecordTrace(bool recordTrace)
+{
+    mRecordTrace = recordTrace;
+    scheduleSave();
+}
+
 void Settings::setStyleStrategy(QFont::StyleStrategy strategy)
 {
     mStyleStrategy = strategy;
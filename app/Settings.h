@@ -31,7 +31,13 @@ public:
     QByteArray           getWindowGeometry() const { return mGeometry;        }
     bool                 isAlwaysOnTop()     const { return mAlwaysOnTop;     }
     int                  getFilterThreshold()const { return mFilterThreshold; }
+    int                  getFilterThreads()  const { return mFilterThreads;   }
+    bool                 isIndexLargeFiles() const { return mIndexLargeFiles; }
+    int                  getResultCacheSize()const { return mResultCacheSize; }
     bool                 isWordWrap()        const { return mWordWrap;        }
+    bool                 isFollowFile()      const { return mFollowFile;      }
+    bool                 isShowTimings()     const { return mShowTimings;     }
+    bool                 isRecordTrace()     const { return mRecordTrace;     }
     QStringList          getRecentFiles()    const { return mRecentFiles;     }
     QFont::StyleStrategy getStyleStrategy()  const { return mStyleStrategy;   }
 
@@ -41,10 +47,19 @@ public:
     void setWindowGeometry(const QByteArray &geometry);
     void setAlwaysOnTop(bool alwaysOnTop);
     void setFilterThreshold(int filterThreshold);
+    void setFilterThreads(int filterThreads);
+    void setIndexLargeFiles(bool indexLargeFiles);
+    void setResultCacheSize(int resultCacheSize);
     void setWordWrap(bool wordWrap);
+    void setFollowFile(bool followFile);
+    void setShowTimings(bool showTimings);
+    void setRecordTrace(bool recordTrace);
     void setStyleStrategy(QFont::StyleStrategy strategy);
     void addRecentFile(const QString &filename);
 
+    // Chrome trace written while recording, next to the INI file
+    QString getTraceFilename() const;
+
     // Force an immediate flush (called on app close).
     void flushNow();
 
@@ -65,7 +80,13 @@ private:
     QByteArray           mGeometry;
     bool                 mAlwaysOnTop;
     int                  mFilterThreshold;
+    int                  mFilterThreads;     // 0 = one per CPU core
+    bool                 mIndexLargeFiles;
+    int                  mResultCacheSize;   // MB, 0 = no cache
     bool                 mWordWrap;
+    bool                 mFollowFile;        // tail -f the open file
+    bool                 mShowTimings;       // stage timings in status bar
+    bool                 mRecordTrace;       // Chrome trace of the session
     QFont::StyleStrategy mStyleStrategy;
     QStringList          mRecentFiles;
 
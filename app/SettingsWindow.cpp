@@ -1,6 +1,7 @@
 #include "SettingsWindow.h"
 #include "ui_SettingsWindow.h"
 #include "Settings.h"
+#include "Document.h"
 #include <QDebug>
 #include <QFontDialog>
 
@@ -13,9 +14,19 @@ SettingsWindow::SettingsWindow(QWidget *parent) :
     setFontTitle();
     ui->checkBoxAlwaysOnTop->setChecked(Settings::getInstance().isAlwaysOnTop());
     ui->spinBoxStartFilter->setValue(Settings::getInstance().getFilterThreshold());
+    ui->spinBoxFilterThreads->setValue(Settings::getInstance().getFilterThreads());
+    ui->checkBoxIndexLargeFiles->setChecked(Settings::getInstance().isIndexLargeFiles());
+    ui->spinBoxResultCache->setValue(Settings::getInstance().getResultCacheSize());
+    setResultCacheStats();
     ui->checkBoxWordWrap->setChecked(Settings::getInstance().isWordWrap());
     ui->comboBoxStyleStrategy->setCurrentIndex(
         styleStrategyToIndex(Settings::getInstance().getStyleStrategy()));
+    ui->checkBoxShowTimings->setChecked(Settings::getInstance().isShowTimings());
+    ui->checkBoxRecordTrace->setChecked(Settings::getInstance().isRecordTrace());
+    ui->checkBoxRecordTrace->setToolTip(
+        tr("Written to %1 when recording is turned off or the application is closed. "
+           "Open it in chrome://tracing or ui.perfetto.dev.")
+            .arg(Settings::getInstance().getTraceFilename()));
 }
 
 SettingsWindow::~SettingsWindow()
@@ -33,14 +44,30 @@ void SettingsWindow::setFontTitle()
     ui->labelFontName->setFont(mFont);
 }
 
+void SettingsWindow::setResultCacheStats()
+{
+    Document::ResultCacheStats stats = Document::getResultCacheStats();
+    QString text = QString("Cache hits: %1, misses: %2, %3 results, %4 MB")
+                       .arg(stats.hits)
+                       .arg(stats.misses)
+                       .arg(stats.resultCount)
+                       .arg(stats.memoryUsage / (1024.0 * 1024.0), 0, 'f', 1);
+    ui->labelResultCacheStats->setText(text);
+}
+
 void SettingsWindow::on_pushButtonOk_clicked()
 {
     Settings::getInstance().setFont(mFont);
     Settings::getInstance().setFilterThreshold(ui->spinBoxStartFilter->value());
+    Settings::getInstance().setFilterThreads(ui->spinBoxFilterThreads->value());
+    Settings::getInstance().setIndexLargeFiles(ui->checkBoxIndexLargeFiles->isChecked());
+    Settings::getInstance().setResultCacheSize(ui->spinBoxResultCache->value());
     Settings::getInstance().setAlwaysOnTop(ui->checkBoxAlwaysOnTop->isChecked());
     Settings::getInstance().setWordWrap(ui->checkBoxWordWrap->isChecked());
     Settings::getInstance().setStyleStrategy(
         indexToStyleStrategy(ui->comboBoxStyleStrategy->currentIndex()));
+    Settings::getInstance().setShowTimings(ui->checkBoxShowTimings->isChecked());
+    Settings::getInstance().setRecordTrace(ui->checkBoxRecordTrace->isChecked());
     emit applySettings();
     close();
 }
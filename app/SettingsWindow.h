@@ -28,6 +28,7 @@ private slots:
 private:
     Ui::SettingsWindow *ui;
     void setFontTitle();
+    void setResultCacheStats();
     QFont mFont;
 
     static QFont::StyleStrategy indexToStyleStrategy(int index);
@@ -1,8 +1,17 @@
+#include "FilterCommand.h"
 #include "MainWindow.h"
 #include <QApplication>
+#include <QCoreApplication>
 
 int main(int argc, char *argv[])
 {
+    // Headless mode needs no display
+    if (FilterCommand::isRequested(argc, argv))
+    {
+        QCoreApplication a(argc, argv);
+        return FilterCommand::run(a.arguments());
+    }
+
     // Force Windows platform plugin to disable dark mode behavior
     qputenv("QT_QPA_PLATFORM", "windows:darkmode=0");
 
@@ -0,0 +1,197 @@
+#include "Corpus.h"
+
+#include <array>
+#include <random>
+
+namespace
+{
+
+template<size_t N>
+const char* pick(std::mt19937& rng, const std::array<const char*, N>& words)
+{
+    return words[std::uniform_int_distribution<size_t>(0, N - 1)(rng)];
+}
+
+int number(std::mt19937& rng, int max)
+{
+    return std::uniform_int_distribution<int>(0, max)(rng);
+}
+
+// Replace %1, %2, ... with args, unlike QString::arg()
+// a pattern does not have to use all of them
+QByteArray fill(const char* pattern, const QStringList& args)
+{
+    QString text = QString::fromUtf8(pattern);
+    for (int i = 0; i < args.size(); ++i)
+    {
+        text.replace(QLatin1Char('%') + QString::number(i + 1), args[i]);
+    }
+    return text.toUtf8();
+}
+
+const std::array<const char*, 16> kWords = {
+    "alpha", "buffer", "client", "delta", "engine", "filter", "gateway", "handler",
+    "index", "journal", "kernel", "listener", "monitor", "network", "omega", "parser"
+};
+
+void appendLogLine(QByteArray& out, std::mt19937& rng, qint64 lineNum)
+{
+    static const std::array<const char*, 8> levels = {
+        "INFO ", "INFO ", "INFO ", "DEBUG", "DEBUG", "WARN ", "ERROR", "TRACE"
+    };
+    static const std::array<const char*, 6> messages = {
+        "Connection from 10.0.%1.%2 accepted, session %3",
+        "Request /api/v2/users/%1 finished in %2 ms, status %3",
+        "Timeout while waiting for %4 after %1 ms, retry %2 of %3",
+        "Cache miss for key %4:%1, loading from %4 store",
+        "User %1 logged in from host-%2.example.com",
+        "Queue %4 has %1 pending items, %2 workers busy, %3 idle"
+    };
+
+    const qint64 seconds = lineNum / 50;
+    out += QStringLiteral("2024-05-01 %1:%2:%3.%4 %5 [%6-%7] ")
+        .arg(seconds / 3600 % 24, 2, 10, QChar('0'))
+        .arg(seconds / 60 % 60, 2, 10, QChar('0'))
+        .arg(seconds % 60, 2, 10, QChar('0'))
+        .arg(number(rng, 999), 3, 10, QChar('0'))
+        .arg(pick(rng, levels))
+        .arg(pick(rng, kWords))
+        .arg(number(rng, 15))
+        .toUtf8();
+    out += fill(pick(rng, messages), {
+        QString::number(number(rng, 255)),
+        QString::number(number(rng, 5000)),
+        QString::number(number(rng, 99999)),
+        pick(rng, kWords)});
+    out += '\n';
+}
+
+void appendCodeLine(QByteArray& out, std::mt19937& rng)
+{
+    static const std::array<const char*, 8> statements = {
+        "if (%1 != nullptr && %1->size() > %3)",
+        "return %1->%2(%3);",
+        "std::vector<%2> %1;",
+        "for (int i = 0; i < %1.size(); ++i)",
+        "// %1 is updated by the %2 before it is used",
+        "const auto %1 = std::make_shared<%2>(%3);",
+        "{",
+        "}"
+    };
+
+    out += QByteArray(number(rng, 3) * 4, ' ');
+    out += fill(pick(rng, statements), {
+        QString::fromLatin1(pick(rng, kWords)) + "Count",
+        pick(rng, kWords),
+        QString::number(number(rng, 1000))});
+    out += '\n';
+}
+
+void appendLongLine(QByteArray& out, std::mt19937& rng)
+{
+    const int wordCount = 300 + number(rng, 2700);
+    for (int i = 0; i < wordCount; ++i)
+    {
+        out += pick(rng, kWords);
+        if (number(rng, 7) == 0)
+        {
+            out += '=';
+            out += QByteArray::number(number(rng, 9999));
+        }
+        out += ' ';
+    }
+    out += '\n';
+}
+
+void appendUnicodeLine(QByteArray& out, std::mt19937& rng)
+{
+    // Cyrillic, Greek, CJK, accented Latin and characters
+    // outside of the BMP, mixed with ASCII like in real text
+    static const std::array<const char*, 12> words = {
+        "Привет", "мир", "ошибка", "Ελληνικά", "σφάλμα", "日本語",
+        "テキスト", "検索", "Größe", "naïve", "😀", "𝒳"
+    };
+
+    const int wordCount = 5 + number(rng, 20);
+    for (int i = 0; i < wordCount; ++i)
+    {
+        out += number(rng, 2) == 0 ? pick(rng, kWords) : pick(rng, words);
+        out += ' ';
+    }
+    out += '\n';
+}
+
+}
+
+Corpus::Corpus(Kind kind, qint64 size)
+    : mKind(kind)
+{
+    std::mt19937 rng(static_cast<unsigned>(kind) + 1);
+
+    mBytes.reserve(size + 64 * 1024);
+    for (qint64 lineNum = 0; mBytes.size() < size; ++lineNum)
+    {
+        switch (kind)
+        {
+        case Kind::Log:
+            appendLogLine(mBytes, rng, lineNum);
+            break;
+        case Kind::Code:
+            appendCodeLine(mBytes, rng);
+            break;
+        case Kind::LongLines:
+            appendLongLine(mBytes, rng);
+            break;
+        case Kind::Unicode:
+            appendUnicodeLine(mBytes, rng);
+            break;
+        }
+    }
+    mBytes.chop(1);
+
+    mText = QString::fromUtf8(mBytes);
+
+    auto buffer = std::make_shared<TextBuffer>();
+    for (QStringView line : QStringView(mText).split(u'\n'))
+    {
+        buffer->appendLine(line);
+    }
+    mBuffer = buffer;
+}
+
+QStringList Corpus::filters() const
+{
+    switch (mKind)
+    {
+    case Kind::Log:
+        return {"error", "timeout retry", "err conn 10.0.4"};
+    case Kind::Code:
+        return {"return", "std vector", "if null size"};
+    case Kind::LongLines:
+        return {"kernel", "alpha omega", "parser=42"};
+    case Kind::Unicode:
+        return {"мир", "größe naïve", "日本 テキ"};
+    }
+    return {};
+}
+
+QList<Corpus::Kind> Corpus::kinds()
+{
+    return {Kind::Log, Kind::Code, Kind::LongLines, Kind::Unicode};
+}
+
+QString Corpus::kindName(Kind kind)
+{
+    switch (kind)
+    {
+    case Kind::Log:
+        return "log";
+    case Kind::Code:
+        return "code";
+    case Kind::LongLines:
+        return "long-lines";
+    case Kind::Unicode:
+        return "unicode";
+    }
+    return QString();
+}
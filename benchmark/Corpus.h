@@ -0,0 +1,52 @@
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include "TextBuffer.h"
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <memory>
+
+// Synthetic text to benchmark on.
+// Generated from a fixed seed, so every run measures the same text.
+class Corpus
+{
+public:
+
+    enum class Kind
+    {
+        Log,
+        Code,
+        LongLines,
+        Unicode
+    };
+
+    // Text of about size bytes of UTF-8, in whole lines
+    Corpus(Kind kind, qint64 size);
+
+    Kind kind() const { return mKind; }
+    QString name() const { return kindName(mKind); }
+
+    // Contents of the file, UTF-8 with \n line breaks
+    const QByteArray& bytes() const { return mBytes; }
+
+    const QString& text() const { return mText; }
+    std::shared_ptr<const TextBuffer> buffer() const { return mBuffer; }
+
+    // Filters a user would type on this kind of text, broad to narrow
+    QStringList filters() const;
+
+    static QList<Kind> kinds();
+    static QString kindName(Kind kind);
+
+private:
+
+    Kind mKind;
+    QByteArray mBytes;
+    QString mText;
+    std::shared_ptr<const TextBuffer> mBuffer;
+};
+
+#endif // CORPUS_H
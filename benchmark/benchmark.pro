@@ -0,0 +1,20 @@
+# Benchmarks of the filter engine and file loading.
+# Run with --help for options, results are written as JSON.
+
+QT = core
+
+TARGET = textfilter-benchmark
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+include(../core/core.pri)
+
+SOURCES += \
+    Corpus.cpp \
+    main.cpp
+
+HEADERS += \
+    Corpus.h
@@ -0,0 +1,373 @@
+#include "Corpus.h"
+#include "Document.h"
+#include "FileManager.h"
+#include "TrigramIndex.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+// Benchmarks of the filter engine and file loading on synthetic text.
+// Results are written as JSON, one object per case, so they can be
+// compared between releases. Times are in milliseconds.
+//
+// Files are read back right after they are written, so load times
+// are for a file in the page cache, as when a file is opened again.
+
+namespace
+{
+
+struct Options
+{
+    std::vector<qint64> sizes;
+    QList<Corpus::Kind> kinds;
+    int iterations = 5;
+    QString caseFilter;
+};
+
+class Runner
+{
+public:
+
+    explicit Runner(const Options& options)
+        : mOptions(options)
+    {
+    }
+
+    // Run body a few times after one warm-up run
+    void measure(
+        const QString& name,
+        const Corpus& corpus,
+        const QString& filter,
+        const std::function<void()>& body)
+    {
+        if (!isSelected(name))
+        {
+            return;
+        }
+
+        body();
+
+        std::vector<double> times;
+        for (int i = 0; i < mOptions.iterations; ++i)
+        {
+            QElapsedTimer timer;
+            timer.start();
+            body();
+            times.push_back(timer.nsecsElapsed() / 1e6);
+        }
+
+        QJsonObject result = describe(name, corpus, filter);
+        addStats(result, times);
+        add(result);
+    }
+
+    // Type filter one character at a time, each keystroke narrows
+    // the result of the previous one, like in the window
+    void measureTyping(const Corpus& corpus, const QString& filter)
+    {
+        const QString name = "filter.typing";
+        if (!isSelected(name))
+        {
+            return;
+        }
+
+        std::vector<double> keystrokes;
+        std::vector<double> totals;
+        for (int i = 0; i <= mOptions.iterations; ++i)
+        {
+            Document document(corpus.buffer());
+            double total = 0;
+            for (int length = 1; length <= filter.size(); ++length)
+            {
+                QElapsedTimer timer;
+                timer.start();
+                document.applyFilter(filter.left(length));
+                const double time = timer.nsecsElapsed() / 1e6;
+
+                // First iteration is the warm-up
+                if (i > 0)
+                {
+                    keystrokes.push_back(time);
+                }
+                total += time;
+            }
+            if (i > 0)
+            {
+                totals.push_back(total);
+            }
+        }
+
+        QJsonObject result = describe(name, corpus, filter);
+        addStats(result, totals);
+
+        std::sort(keystrokes.begin(), keystrokes.end());
+        result["keystrokes"] = int(filter.size());
+        result["keystrokeMedianMs"] = keystrokes[keystrokes.size() / 2];
+        result["keystrokeMaxMs"] = keystrokes.back();
+        add(result);
+    }
+
+    QJsonArray results() const { return mResults; }
+
+private:
+
+    bool isSelected(const QString& name) const
+    {
+        return mOptions.caseFilter.isEmpty() || name.contains(mOptions.caseFilter);
+    }
+
+    static QJsonObject describe(const QString& name, const Corpus& corpus, const QString& filter)
+    {
+        QJsonObject result;
+        result["name"] = name;
+        result["corpus"] = corpus.name();
+        result["bytes"] = double(corpus.bytes().size());
+        result["lines"] = corpus.buffer()->lineCount();
+        if (!filter.isEmpty())
+        {
+            result["filter"] = filter;
+        }
+        return result;
+    }
+
+    static void addStats(QJsonObject& result, std::vector<double> times)
+    {
+        std::sort(times.begin(), times.end());
+        result["iterations"] = int(times.size());
+        result["minMs"] = times.front();
+        result["medianMs"] = times[times.size() / 2];
+        result["maxMs"] = times.back();
+    }
+
+    void add(const QJsonObject& result)
+    {
+        // Progress goes to stderr, so stdout stays valid JSON
+        std::fprintf(stderr, "%-20s %-10s %12lld bytes %-20s %10.3f ms\n",
+                     qUtf8Printable(result["name"].toString()),
+                     qUtf8Printable(result["corpus"].toString()),
+                     qlonglong(result["bytes"].toDouble()),
+                     qUtf8Printable(result["filter"].toString()),
+                     result["medianMs"].toDouble());
+        mResults.append(result);
+    }
+
+    const Options& mOptions;
+    QJsonArray mResults;
+};
+
+void runCorpus(Runner& runner, const Corpus& corpus, const QString& directory)
+{
+    const std::shared_ptr<const TextBuffer> text = corpus.buffer();
+
+    runner.measure("text.fold", corpus, QString(), [&corpus]()
+    {
+        TextBuffer buffer;
+        for (QStringView line : QStringView(corpus.text()).split(u'\n'))
+        {
+            buffer.appendLine(line);
+        }
+    });
+
+    std::shared_ptr<const TrigramIndex> index;
+    runner.measure("index.build", corpus, QString(), [&text, &index]()
+    {
+        index = std::make_shared<const TrigramIndex>(*text);
+    });
+    if (index == nullptr)
+    {
+        index = std::make_shared<const TrigramIndex>(*text);
+    }
+
+    for (const QString& filter : corpus.filters())
+    {
+        runner.measure("filter.scan", corpus, filter, [&text, &filter]()
+        {
+            Document::FilterTask task;
+            task.text = text;
+            task.filter = filter;
+            Document::runFilterTask(task);
+        });
+
+        runner.measure("filter.indexed", corpus, filter, [&text, &index, &filter]()
+        {
+            Document::FilterTask task;
+            task.text = text;
+            task.index = index;
+            task.filter = filter;
+            Document::runFilterTask(task);
+        });
+
+        runner.measureTyping(corpus, filter);
+
+        // Enter pressed over every match of the filter
+        Document document(text);
+        document.applyFilter(filter);
+        runner.measure("highlight.next", corpus, filter, [&document]()
+        {
+            for (int i = 0; i < document.getFilteredLineCount(); ++i)
+            {
+                document.highlightNextLine();
+            }
+        });
+    }
+
+    const QString filename = directory + "/" + corpus.name() + ".txt";
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly) || file.write(corpus.bytes()) != corpus.bytes().size())
+    {
+        std::fprintf(stderr, "Cannot write %s\n", qUtf8Printable(filename));
+        return;
+    }
+    file.close();
+
+    runner.measure("file.load", corpus, QString(), [&filename]()
+    {
+        FileManager::load(filename);
+    });
+
+    runner.measure("file.loadChunks", corpus, QString(), [&filename]()
+    {
+        FileManager::loadChunks(
+            filename,
+            [](const QString&, qint64, qint64) {},
+            []() { return false; });
+    });
+
+    const QString savedFilename = directory + "/" + corpus.name() + ".saved.txt";
+    runner.measure("file.save", corpus, QString(), [&corpus, &savedFilename]()
+    {
+        FileManager::save(savedFilename, corpus.text());
+    });
+}
+
+// 512K, 16M, 1G or plain bytes
+qint64 parseSize(const QString& text)
+{
+    qint64 multiplier = 1;
+    QString digits = text.trimmed().toUpper();
+    if (digits.endsWith('K'))
+    {
+        multiplier = 1024;
+    }
+    else if (digits.endsWith('M'))
+    {
+        multiplier = 1024 * 1024;
+    }
+    else if (digits.endsWith('G'))
+    {
+        multiplier = 1024 * 1024 * 1024;
+    }
+    if (multiplier != 1)
+    {
+        digits.chop(1);
+    }
+
+    bool ok = false;
+    const qint64 size = digits.toLongLong(&ok);
+    return ok && size > 0 ? size * multiplier : -1;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmarks of the TextFilter engine, results are written as JSON.");
+    parser.addHelpOption();
+    parser.addOption({"sizes", "Corpus sizes, e.g. 1M,64M,1G.", "sizes", "1M,16M"});
+    parser.addOption({"corpus", "Corpora to use: log, code, long-lines, unicode.", "names",
+                      "log,code,long-lines,unicode"});
+    parser.addOption({"iterations", "Measured runs of every case.", "count", "5"});
+    parser.addOption({"case", "Run only cases whose name contains this text.", "text"});
+    parser.addOption({"threads", "Filter worker threads, 0 for one per core.", "count", "0"});
+    parser.addOption({{"o", "output"}, "Write JSON here instead of stdout.", "file"});
+    parser.process(app);
+
+    Options options;
+    for (const QString& size : parser.value("sizes").split(',', Qt::SkipEmptyParts))
+    {
+        const qint64 bytes = parseSize(size);
+        if (bytes < 0)
+        {
+            std::fprintf(stderr, "Invalid size: %s\n", qUtf8Printable(size));
+            return 2;
+        }
+        options.sizes.push_back(bytes);
+    }
+
+    const QStringList kindNames = parser.value("corpus").split(',', Qt::SkipEmptyParts);
+    for (Corpus::Kind kind : Corpus::kinds())
+    {
+        if (kindNames.contains(Corpus::kindName(kind)))
+        {
+            options.kinds.append(kind);
+        }
+    }
+
+    options.iterations = std::max(1, parser.value("iterations").toInt());
+    options.caseFilter = parser.value("case");
+
+    // Measured the same way as in the window, except that results
+    // are never cached, and the index is measured on its own
+    Document::setWorkerCount(parser.value("threads").toInt());
+    Document::setIndexingEnabled(false);
+    Document::setResultCacheBudget(0);
+
+    QTemporaryDir directory;
+    if (!directory.isValid())
+    {
+        std::fprintf(stderr, "Cannot create a temporary directory\n");
+        return 2;
+    }
+
+    Runner runner(options);
+    for (qint64 size : options.sizes)
+    {
+        for (Corpus::Kind kind : options.kinds)
+        {
+            const Corpus corpus(kind, size);
+            runCorpus(runner, corpus, directory.path());
+        }
+    }
+
+    QJsonObject report;
+    report["date"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    report["qtVersion"] = QString(qVersion());
+    report["os"] = QSysInfo::prettyProductName();
+    report["cpuArchitecture"] = QSysInfo::currentCpuArchitecture();
+    report["idealThreadCount"] = QThread::idealThreadCount();
+    report["results"] = runner.results();
+
+    const QByteArray json = QJsonDocument(report).toJson();
+    if (parser.isSet("output"))
+    {
+        QFile output(parser.value("output"));
+        if (!output.open(QIODevice::WriteOnly) || output.write(json) != json.size())
+        {
+            std::fprintf(stderr, "Cannot write %s\n", qUtf8Printable(output.fileName()));
+            return 2;
+        }
+    }
+    else
+    {
+        std::fwrite(json.constData(), 1, json.size(), stdout);
+    }
+    return 0;
+}
@@ -0,0 +1,780 @@
+#include "Document.h"
+#include "Trace.h"
+
+#include <QDebug>
+#include <QHash>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <list>
+#include <numeric>
+#include <unordered_map>
+
+struct Document::FilterResult
+{
+    // Holds the match arrays, released together with the result
+    std::pmr::monotonic_buffer_resource arena;
+
+    QStringList filterItems;
+    MatchList matches{&arena};
+
+    // Lines of the text the matches were found in. Appends keep the
+    // revision of a text, so for a text with more lines the result
+    // is valid for all lines but its last, which may have been continued.
+    int lineCount = 0;
+
+    // Results this one was narrowed from, oldest first.
+    // Each of them matches a superset of the lines of the next one.
+    std::vector<std::shared_ptr<const FilterResult>> history;
+};
+
+namespace
+{
+
+// Smaller chunks cost more in thread hand-off than they save
+constexpr int kMinLinesPerChunk = 16384;
+
+// How often a scan checks whether it was cancelled, must be a power of 2
+constexpr int kCancelCheckLines = 1024;
+
+// How many earlier results are kept for Backspace
+constexpr int kMaxFilterHistory = 16;
+
+// Smaller documents are scanned faster than the index is built
+constexpr qsizetype kMinIndexedTextLength = 4 * 1024 * 1024;
+
+bool indexingEnabled = true;
+
+QThreadPool& filterThreadPool()
+{
+    static QThreadPool pool;
+    return pool;
+}
+
+// Results of recent filters on one text, keyed by the folded filter items.
+// Used from the GUI thread only.
+//
+// A result keeps the results it was narrowed from in its history, and
+// results share them, so the memory of every result reachable from
+// the cache is counted once, however many entries hold it.
+class ResultCache
+{
+public:
+
+    using Result = std::shared_ptr<const Document::FilterResult>;
+
+    // Drop all results if the text changed.
+    // Appending lines to it keeps the revision.
+    void setRevision(quint64 revision)
+    {
+        if (revision != mRevision)
+        {
+            mEntries.clear();
+            mIndex.clear();
+            mCharges.clear();
+            mMemoryUsage = 0;
+            mRevision = revision;
+        }
+    }
+
+    Result find(const QString& key)
+    {
+        auto it = mIndex.find(key);
+        if (it == mIndex.end())
+        {
+            ++mStats.misses;
+            return nullptr;
+        }
+
+        ++mStats.hits;
+        mEntries.splice(mEntries.begin(), mEntries, it.value());
+        return it.value()->result;
+    }
+
+    // Replaces the result of the same filter, e.g. with
+    // the one of a text with lines appended
+    void insert(const QString& key, Result result)
+    {
+        auto it = mIndex.find(key);
+        if (it != mIndex.end())
+        {
+            remove(it.value());
+        }
+
+        Entry entry{key, result, result->history};
+        entry.charged.push_back(std::move(result));
+        for (const Result& charged : entry.charged)
+        {
+            charge(charged);
+        }
+
+        mEntries.push_front(std::move(entry));
+        mIndex.insert(key, mEntries.begin());
+        evict();
+    }
+
+    void setBudget(size_t budget)
+    {
+        mBudget = budget;
+        evict();
+    }
+
+    Document::ResultCacheStats stats() const
+    {
+        Document::ResultCacheStats stats = mStats;
+        stats.resultCount = static_cast<int>(mEntries.size());
+        stats.memoryUsage = mMemoryUsage;
+        return stats;
+    }
+
+private:
+
+    struct Entry
+    {
+        QString key;
+        Result result;
+
+        // The result and its history
+        std::vector<Result> charged;
+    };
+
+    // Memory of a result as it was charged, and how many entries hold it
+    struct Charge
+    {
+        int count = 0;
+        size_t memoryUsage = 0;
+    };
+
+    // Results never change once made, a result held
+    // by other entries too is already charged
+    void charge(const Result& result)
+    {
+        Charge& charge = mCharges[result.get()];
+        if (charge.count++ == 0)
+        {
+            charge.memoryUsage = result->matches.memoryUsage();
+            mMemoryUsage += charge.memoryUsage;
+        }
+    }
+
+    void uncharge(const Result& result)
+    {
+        auto it = mCharges.find(result.get());
+        if (--it->second.count == 0)
+        {
+            mMemoryUsage -= it->second.memoryUsage;
+            mCharges.erase(it);
+        }
+    }
+
+    void remove(std::list<Entry>::iterator entry)
+    {
+        for (const Result& charged : entry->charged)
+        {
+            uncharge(charged);
+        }
+        mIndex.remove(entry->key);
+        mEntries.erase(entry);
+    }
+
+    void evict()
+    {
+        while (mMemoryUsage > mBudget && !mEntries.empty())
+        {
+            remove(std::prev(mEntries.end()));
+        }
+    }
+
+    // Most recently used first
+    std::list<Entry> mEntries;
+    QHash<QString, std::list<Entry>::iterator> mIndex;
+    std::unordered_map<const Document::FilterResult*, Charge> mCharges;
+
+    quint64 mRevision = 0;
+    size_t mBudget = 0;
+    size_t mMemoryUsage = 0;
+    Document::ResultCacheStats mStats;
+};
+
+ResultCache& resultCache()
+{
+    static ResultCache cache;
+    return cache;
+}
+
+// Filters with the same items match the same lines,
+// whatever the case and the spaces between items
+QString resultCacheKey(const QString& filter)
+{
+    return TextBuffer::foldCase(filter.split(" ", Qt::SkipEmptyParts).join(' '));
+}
+
+}
+
+
+Document::Document(
+    std::shared_ptr<const TextBuffer> text,
+    std::shared_ptr<const TrigramIndex> previousIndex)
+    : mFilter("")
+    , mText(std::move(text))
+    , mPreviousIndex(std::move(previousIndex))
+    , mCurrentHighlightedLine(-1)
+{
+    resultCache().setRevision(mText->revision());
+
+    updateIndex();
+}
+
+void Document::setWorkerCount(int workerCount)
+{
+    filterThreadPool().setMaxThreadCount(
+        workerCount > 0 ? workerCount : QThread::idealThreadCount());
+}
+
+void Document::setIndexingEnabled(bool isEnabled)
+{
+    indexingEnabled = isEnabled;
+}
+
+void Document::setResultCacheBudget(size_t bytes)
+{
+    resultCache().setBudget(bytes);
+}
+
+Document::ResultCacheStats Document::getResultCacheStats()
+{
+    return resultCache().stats();
+}
+
+std::shared_ptr<const TrigramIndex> Document::getTrigramIndex() const
+{
+    if (mIndexFuture.isValid() && mIndexFuture.isFinished())
+    {
+        return mIndexFuture.result();
+    }
+    return indexingEnabled ? mPreviousIndex : nullptr;
+}
+
+void Document::applyFilter(const QString& filter)
+{
+    setFilterResult(filter, runFilterTask(createFilterTask(filter)));
+}
+
+Document::FilterTask Document::createFilterTask(const QString& filter)
+{
+    // Index of lines appended while the last update was running
+    updateIndex();
+
+    FilterTask task;
+    task.text = mText;
+    if (mIndexText == mText && mIndexFuture.isFinished())
+    {
+        task.index = mIndexFuture.result();
+    }
+    task.previous = mFilter.isEmpty() ? nullptr : mFilterResult;
+    task.filter = filter;
+    if (!filter.trimmed().isEmpty())
+    {
+        task.cached = resultCache().find(resultCacheKey(filter));
+
+        // Text of the same revision with fewer lines,
+        // e.g. the one this Document was made from
+        if (task.cached != nullptr && task.cached->lineCount > mText->lineCount())
+        {
+            task.cached = nullptr;
+        }
+    }
+    return task;
+}
+
+std::shared_ptr<const Document::FilterResult> Document::runFilterTask(
+    const FilterTask& task,
+    const std::function<bool()>& isCancelled)
+{
+    const FilterQuery query(task.filter);
+
+    if (task.cached != nullptr)
+    {
+        if (task.cached->lineCount == task.text->lineCount())
+        {
+            return task.cached;
+        }
+
+        // Lines were appended since the result was cached
+        return appendedResult(*task.cached, *task.text, query, isCancelled);
+    }
+
+    auto result = std::make_shared<FilterResult>();
+    result->lineCount = task.text->lineCount();
+    if (task.filter.isEmpty())
+    {
+        return result;
+    }
+
+    result->filterItems = query.items();
+
+    // Result of the same text, which the filter may narrow
+    const FilterResult* previous =
+        task.previous != nullptr && task.previous->lineCount == result->lineCount
+            ? task.previous.get()
+            : nullptr;
+
+    if (previous != nullptr)
+    {
+        // Only spaces were added or removed, result stays the same
+        if (previous->filterItems == result->filterItems)
+        {
+            return task.previous;
+        }
+
+        // Backspace: the filter was typed before, reuse its result
+        for (auto it = previous->history.rbegin(); it != previous->history.rend(); ++it)
+        {
+            if ((*it)->filterItems == result->filterItems)
+            {
+                return *it;
+            }
+        }
+    }
+
+    // Lines which contain all trigrams of the filter items
+    std::vector<int> candidates;
+    bool hasCandidates = false;
+    if (task.index != nullptr && task.index->lineCount() == task.text->lineCount())
+    {
+        Trace::Scope scope("filter.candidates");
+        hasCandidates = task.index->findCandidates(query, candidates);
+        if (hasCandidates)
+        {
+            scope.setCounter("candidates", qint64(candidates.size()));
+        }
+    }
+
+    bool finished = false;
+    if (previous != nullptr && isNarrowing(previous->filterItems, result->filterItems))
+    {
+        // Characters were appended: only lines matched by the
+        // previous filter can match the new one
+        const std::pmr::vector<int>& previousLines = previous->matches.lines();
+        const int* lineNumbers = previousLines.data();
+        int lineCount = previous->matches.size();
+
+        std::vector<int> narrowedCandidates;
+        if (hasCandidates)
+        {
+            std::set_intersection(
+                previousLines.begin(),
+                previousLines.end(),
+                candidates.begin(),
+                candidates.end(),
+                std::back_inserter(narrowedCandidates));
+            lineNumbers = narrowedCandidates.data();
+            lineCount = static_cast<int>(narrowedCandidates.size());
+        }
+
+        finished = scan(
+            *task.text,
+            lineNumbers,
+            lineCount,
+            query,
+            isCancelled,
+            result->matches);
+
+        result->history = previous->history;
+        if (static_cast<int>(result->history.size()) >= kMaxFilterHistory)
+        {
+            result->history.erase(result->history.begin());
+        }
+        result->history.push_back(task.previous);
+    }
+    else if (hasCandidates)
+    {
+        finished = scan(
+            *task.text,
+            candidates.data(),
+            static_cast<int>(candidates.size()),
+            query,
+            isCancelled,
+            result->matches);
+    }
+    else
+    {
+        finished = scan(
+            *task.text,
+            nullptr,
+            task.text->lineCount(),
+            query,
+            isCancelled,
+            result->matches);
+    }
+
+    return finished ? result : nullptr;
+}
+
+void Document::setFilterResult(
+    const QString& filter,
+    std::shared_ptr<const FilterResult> result)
+{
+    mFilter = filter;
+    mFilterResult = std::move(result);
+
+    // Lines were appended while the pass was running
+    if (mFilterResult != nullptr
+        && !filter.isEmpty()
+        && mFilterResult->lineCount < mText->lineCount())
+    {
+        mFilterResult = appendedResult(*mFilterResult, *mText, FilterQuery(filter), nullptr);
+    }
+
+    if (mFilterResult != nullptr && !filter.trimmed().isEmpty())
+    {
+        resultCache().insert(
+            resultCacheKey(filter),
+            mFilterResult);
+    }
+
+    mCurrentHighlightedLine = -1;
+}
+
+bool Document::appendText(std::shared_ptr<const TextBuffer> text)
+{
+    if (text->revision() != mText->revision() || text->lineCount() < mText->lineCount())
+    {
+        return false;
+    }
+
+    // Revision stays: cached results are still valid for the lines
+    // before the changed one, they are brought up to date when used
+    mText = std::move(text);
+    updateIndex();
+
+    if (mFilterResult == nullptr || mFilter.isEmpty())
+    {
+        return true;
+    }
+
+    // Results are shared with the cache and with passes, a new one
+    // replaces the current one and is charged its own size
+    mFilterResult = appendedResult(*mFilterResult, *mText, FilterQuery(mFilter), nullptr);
+
+    if (!mFilter.trimmed().isEmpty())
+    {
+        resultCache().insert(
+            resultCacheKey(mFilter),
+            mFilterResult);
+    }
+    return true;
+}
+
+void Document::updateIndex()
+{
+    if (!indexingEnabled || mText->length() < kMinIndexedTextLength || mIndexText == mText)
+    {
+        return;
+    }
+
+    if (!mIndexFuture.isValid())
+    {
+        // Lines which did not change since the previous index are reused
+        std::shared_ptr<const TrigramIndex> previous = mPreviousIndex;
+        mIndexFuture = QtConcurrent::run(
+            [text = mText, previous]() -> std::shared_ptr<const TrigramIndex>
+            {
+                Trace::Scope scope("index.build");
+                scope.setCounter("lines", text->lineCount());
+                if (previous != nullptr)
+                {
+                    return std::make_shared<const TrigramIndex>(*previous, *text);
+                }
+                return std::make_shared<const TrigramIndex>(*text);
+            });
+        mIndexText = mText;
+        return;
+    }
+
+    // One update at a time. Lines appended meanwhile
+    // are indexed by the next update, all in one go.
+    if (!mIndexFuture.isFinished())
+    {
+        return;
+    }
+
+    std::shared_ptr<const TrigramIndex> previous = mIndexFuture.result();
+    mIndexFuture = QtConcurrent::run(
+        [text = mText, previous]() -> std::shared_ptr<const TrigramIndex>
+        {
+            // Text only grew since the previous index,
+            // its last line may have been continued
+            const int firstChangedLine = std::max(0, previous->lineCount() - 1);
+            Trace::Scope scope("index.update");
+            scope.setCounter("lines", text->lineCount() - firstChangedLine);
+            return std::make_shared<const TrigramIndex>(*previous, *text, firstChangedLine);
+        });
+    mIndexText = mText;
+}
+
+std::shared_ptr<const Document::FilterResult> Document::appendedResult(
+    const FilterResult& result,
+    const TextBuffer& text,
+    const FilterQuery& query,
+    const std::function<bool()>& isCancelled)
+{
+    const int firstChangedLine = std::max(0, result.lineCount - 1);
+    MatchList newMatches;
+    if (!scanFrom(text, firstChangedLine, query, isCancelled, newMatches))
+    {
+        return nullptr;
+    }
+
+    // History was narrowed on the text before the append, it is dropped
+    auto appended = std::make_shared<FilterResult>();
+    appended->filterItems = result.filterItems;
+    appended->lineCount = text.lineCount();
+    const int keptCount = result.matches.nextIndex(firstChangedLine - 1);
+    appended->matches.reserve(
+        keptCount + newMatches.size(),
+        static_cast<int>(result.matches.areaBegin(keptCount) - result.matches.areaBegin(0))
+            + newMatches.areaCount());
+    appended->matches.append(result.matches, keptCount);
+    appended->matches.append(newMatches);
+    return appended;
+}
+
+bool Document::scanFrom(
+    const TextBuffer& text,
+    int firstLine,
+    const FilterQuery& query,
+    const std::function<bool()>& isCancelled,
+    MatchList& matches)
+{
+    std::vector<int> lineNumbers(text.lineCount() - firstLine);
+    std::iota(lineNumbers.begin(), lineNumbers.end(), firstLine);
+
+    return scan(
+        text,
+        lineNumbers.data(),
+        static_cast<int>(lineNumbers.size()),
+        query,
+        isCancelled,
+        matches);
+}
+
+void Document::filterText(
+    const TextBuffer& text,
+    const FilterQuery& query,
+    MatchList& matches)
+{
+    scan(text, nullptr, text.lineCount(), query, nullptr, matches);
+}
+
+std::shared_ptr<const MatchList> Document::getMatches() const
+{
+    if (mFilterResult == nullptr)
+    {
+        return std::make_shared<const MatchList>();
+    }
+    return std::shared_ptr<const MatchList>(mFilterResult, &mFilterResult->matches);
+}
+
+const MatchList& Document::matches() const
+{
+    static const MatchList noMatches;
+    return mFilterResult ? mFilterResult->matches : noMatches;
+}
+
+bool Document::isNarrowing(
+    const QStringList& oldItems,
+    const QStringList& newItems)
+{
+    if (oldItems.isEmpty() || oldItems.size() > newItems.size())
+    {
+        return false;
+    }
+
+    const int last = oldItems.size() - 1;
+    for (int i = 0; i < last; ++i)
+    {
+        if (oldItems[i] != newItems[i])
+        {
+            return false;
+        }
+    }
+
+    // Wherever the new item matches, the old one matches inside it,
+    // so the old in-order match is still satisfied
+    return newItems[last].contains(oldItems[last], Qt::CaseInsensitive);
+}
+
+Document::ScanChunk::ScanChunk(int begin, int end)
+    : begin(begin)
+    , end(end)
+    , arena(std::make_unique<std::pmr::monotonic_buffer_resource>())
+    , matches(arena.get())
+{
+}
+
+bool Document::scan(
+    const TextBuffer& text,
+    const int* lineNumbers,
+    int lineCount,
+    const FilterQuery& query,
+    const std::function<bool()>& isCancelled,
+    MatchList& matches)
+{
+    Trace::Scope scope("filter.scan");
+    scope.setCounter("lines", lineCount);
+
+    matches.clear();
+
+    // Few chunks per worker, so one chunk full of long lines
+    // does not leave the other workers idle at the end
+    const int workerCount = std::max(1, filterThreadPool().maxThreadCount());
+    const int chunkSize =
+        std::max(kMinLinesPerChunk, lineCount / (workerCount * 4) + 1);
+
+    std::vector<ScanChunk> chunks;
+    chunks.reserve(lineCount / chunkSize + 1);
+    for (int begin = 0; begin < lineCount; begin += chunkSize)
+    {
+        chunks.emplace_back(begin, std::min(lineCount, begin + chunkSize));
+    }
+
+    std::atomic<bool> cancelled(false);
+
+    auto scanChunk = [&](ScanChunk& chunk)
+    {
+        Trace::Scope chunkScope("filter.scanChunk");
+        chunkScope.setCounter("lines", chunk.end - chunk.begin);
+
+        std::pmr::vector<HighlightArea> lineAreas(chunk.arena.get());
+        lineAreas.reserve(query.itemCount());
+        TextBuffer::Reader reader(text);
+
+        for (int i = chunk.begin; i < chunk.end; ++i)
+        {
+            if (isCancelled && (i & (kCancelCheckLines - 1)) == 0)
+            {
+                if (cancelled.load(std::memory_order_relaxed) || isCancelled())
+                {
+                    cancelled.store(true, std::memory_order_relaxed);
+                    return;
+                }
+            }
+
+            const int lineNum = lineNumbers ? lineNumbers[i] : i;
+            if (filterLine(
+                    reader.foldedLine(lineNum),
+                    reader.isFoldedLineAscii(lineNum),
+                    query,
+                    lineAreas))
+            {
+                chunk.matches.append(lineNum, lineAreas);
+            }
+        }
+    };
+
+    if (chunks.size() <= 1 || workerCount == 1)
+    {
+        for (ScanChunk& chunk : chunks)
+        {
+            scanChunk(chunk);
+        }
+    }
+    else
+    {
+        QtConcurrent::blockingMap(&filterThreadPool(), chunks, scanChunk);
+    }
+
+    if (cancelled || (isCancelled && isCancelled()))
+    {
+        return false;
+    }
+
+    // Chunks cover ascending line ranges, so appending them in order
+    // gives exactly the list the serial scan would build
+    int lineCountTotal = 0;
+    int areaCountTotal = 0;
+    for (const ScanChunk& chunk : chunks)
+    {
+        lineCountTotal += chunk.matches.size();
+        areaCountTotal += chunk.matches.areaCount();
+    }
+
+    matches.reserve(lineCountTotal, areaCountTotal);
+    for (const ScanChunk& chunk : chunks)
+    {
+        matches.append(chunk.matches);
+    }
+
+    scope.setCounter("matches", matches.size());
+    scope.setCounter("bytes", qint64(matches.memoryUsage()));
+    return true;
+}
+
+bool Document::filterLine(
+    QStringView foldedLine,
+    bool isLineAscii,
+    const FilterQuery& query,
+    std::pmr::vector<HighlightArea>& highlightAreas)
+{
+    highlightAreas.clear();
+
+    if (!query.mayMatch(foldedLine, isLineAscii))
+    {
+        return false;
+    }
+
+    qsizetype fromIndex = 0;
+
+    for (int item = 0; item < query.itemCount(); ++item)
+    {
+        qsizetype indexOf = query.indexOf(item, foldedLine, fromIndex, isLineAscii);
+        if (indexOf == -1)
+        {
+            return false;
+        }
+        fromIndex = indexOf + query.itemLength(item);
+        highlightAreas.emplace_back(
+            static_cast<int>(indexOf),
+            static_cast<int>(fromIndex));
+    }
+    return true;
+}
+
+int Document::highlightPrevLine()
+{
+    const MatchList& matchedLines = matches();
+    if (!matchedLines.isEmpty())
+    {
+        int n = matchedLines.previousIndex(mCurrentHighlightedLine);
+        if (n < 0)
+        {
+            n = matchedLines.size() - 1;
+        }
+
+        mCurrentHighlightedLine = matchedLines.lineAt(n);
+    }
+
+    return mCurrentHighlightedLine;
+}
+
+int Document::highlightNextLine()
+{
+    const MatchList& matchedLines = matches();
+    if (!matchedLines.isEmpty())
+    {
+        int n = matchedLines.nextIndex(mCurrentHighlightedLine);
+        if (n == matchedLines.size())
+        {
+            n = 0;
+        }
+
+        mCurrentHighlightedLine = matchedLines.lineAt(n);
+    }
+
+    return mCurrentHighlightedLine;
+}
@@ -0,0 +1,209 @@
+#ifndef DOCUMENT_H
+#define DOCUMENT_H
+
+#include "FilterQuery.h"
+#include "MatchList.h"
+#include "TextBuffer.h"
+#include "TrigramIndex.h"
+
+#include <QFuture>
+#include <QStringList>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+
+class Document
+{
+public:
+
+    // previousIndex is the trigram index of an earlier version of
+    // the text, only lines changed since then are indexed again
+    Document(
+        std::shared_ptr<const TextBuffer> text,
+        std::shared_ptr<const TrigramIndex> previousIndex = nullptr);
+
+    // Matched lines of one filter
+    // Defined in Document.cpp, other classes only pass it around
+    struct FilterResult;
+
+    // Everything a filter pass needs to run.
+    // It holds immutable snapshots only, so it can run
+    // on a worker thread and may outlive the Document.
+    struct FilterTask
+    {
+        std::shared_ptr<const TextBuffer> text;
+        std::shared_ptr<const TrigramIndex> index;
+        std::shared_ptr<const FilterResult> previous;
+        QString filter;
+
+        // Set if the filter was run on this text, or on it before
+        // lines were appended
+        std::shared_ptr<const FilterResult> cached;
+    };
+
+    struct ResultCacheStats
+    {
+        int hits = 0;
+        int misses = 0;
+        int resultCount = 0;
+        size_t memoryUsage = 0;
+    };
+
+    void applyFilter(const QString& filter);
+
+    FilterTask createFilterTask(const QString& filter);
+
+    // Find lines matching the task filter.
+    // Can be called from any thread. Returns nullptr if
+    // isCancelled() returned true before the pass was finished.
+    static std::shared_ptr<const FilterResult> runFilterTask(
+        const FilterTask& task,
+        const std::function<bool()>& isCancelled = nullptr);
+
+    // Make result of runFilterTask() current. If lines were appended
+    // since its pass started, only they are filtered on top of it.
+    void setFilterResult(
+        const QString& filter,
+        std::shared_ptr<const FilterResult> result);
+
+    // Make text current if it is the current text with text appended,
+    // e.g. lines written to a followed file. Returns false otherwise.
+    // Only the last line and the new lines are filtered, the current
+    // result is replaced by one with their matches appended.
+    bool appendText(std::shared_ptr<const TextBuffer> text);
+
+    // Text which is filtered, one line per block of the document
+    std::shared_ptr<const TextBuffer> getText() const { return mText; }
+
+    // Matched lines of the current filter result
+    std::shared_ptr<const MatchList> getMatches() const;
+
+    // Make the previous or next matched line current, wrapping around.
+    // Returns the current line, -1 if nothing matched.
+    int highlightPrevLine();
+    int highlightNextLine();
+
+    QString getFilter() const { return mFilter; }
+
+    // Number of threads used to scan the document
+    // 0 means one thread per CPU core
+    static void setWorkerCount(int workerCount);
+
+    // Build trigram index for large documents in background
+    static void setIndexingEnabled(bool isEnabled);
+
+    // Results of recent filters are kept until the text changes,
+    // least recently used ones are dropped when over the budget.
+    // The results kept for Backspace count against it too, once
+    // however many results share them.
+    // Appended lines do not drop them, they are filtered when
+    // a result is used again.
+    // 0 disables the cache.
+    static void setResultCacheBudget(size_t bytes);
+    static ResultCacheStats getResultCacheStats();
+
+    // Find lines of text matching the query without a Document,
+    // scanned in parallel the same way as in a filter pass
+    static void filterText(
+        const TextBuffer& text,
+        const FilterQuery& query,
+        MatchList& matches);
+
+    // Index to pass to the next Document made from this text,
+    // nullptr if there is none yet
+    std::shared_ptr<const TrigramIndex> getTrigramIndex() const;
+
+    int getCurrentHighlightedLineNum() const { return mCurrentHighlightedLine; }
+    void setCurrentHighlightedLineNum(int lineNum) { mCurrentHighlightedLine = lineNum; }
+    int getFilteredLineCount() const { return matches().size(); }
+
+private:
+
+    // Matches found in one range of scanned lines.
+    // Every chunk allocates from its own arena, so worker threads
+    // do not contend in malloc, and the arena is dropped at once
+    // after the matches are copied into the result.
+    struct ScanChunk
+    {
+        ScanChunk(int begin, int end);
+
+        int begin;
+        int end;
+        std::unique_ptr<std::pmr::monotonic_buffer_resource> arena;
+        MatchList matches;
+    };
+
+    // Search for line with fuzzy filter match
+    // If line matches, highlightAreas gets the area of each filter item.
+    // The vector is reused between lines, so matching does not allocate.
+    static bool filterLine(
+        QStringView foldedLine,
+        bool isLineAscii,
+        const FilterQuery& query,
+        std::pmr::vector<HighlightArea>& highlightAreas);
+
+    // True if every line matching newItems also matches oldItems,
+    // i.e. the new filter can only narrow the previous result
+    static bool isNarrowing(
+        const QStringList& oldItems,
+        const QStringList& newItems);
+
+    // Run filterLine over lineCount lines, split into chunks
+    // which are scanned in parallel on large documents.
+    // If lineNumbers is set, i-th scanned line is lineNumbers[i],
+    // otherwise it is line i.
+    // Returns false if the scan was cancelled.
+    static bool scan(
+        const TextBuffer& text,
+        const int* lineNumbers,
+        int lineCount,
+        const FilterQuery& query,
+        const std::function<bool()>& isCancelled,
+        MatchList& matches);
+
+    // Scan lines from firstLine to the end of text
+    static bool scanFrom(
+        const TextBuffer& text,
+        int firstLine,
+        const FilterQuery& query,
+        const std::function<bool()>& isCancelled,
+        MatchList& matches);
+
+    // Result for text, which is the text of result with lines appended.
+    // Only its last line and the new lines are filtered, matches of
+    // the lines before are copied. Returns nullptr if cancelled.
+    static std::shared_ptr<const FilterResult> appendedResult(
+        const FilterResult& result,
+        const TextBuffer& text,
+        const FilterQuery& query,
+        const std::function<bool()>& isCancelled);
+
+    // Matches of the current filter result
+    const MatchList& matches() const;
+
+    // Start indexing the current text if it is large enough and
+    // the index is behind it. Returns at once if an update is running.
+    void updateIndex();
+
+private:
+    QString mFilter;
+
+    // Snapshot of the text of every block of the document.
+    // Worker threads read lines from here, never from the document.
+    std::shared_ptr<const TextBuffer> mText;
+
+    // Built in background, filtering scans all lines until it is ready.
+    // mIndexText is the text the last started build or update indexes.
+    QFuture<std::shared_ptr<const TrigramIndex>> mIndexFuture;
+    std::shared_ptr<const TextBuffer> mIndexText;
+    std::shared_ptr<const TrigramIndex> mPreviousIndex;
+
+    // To iterate over highighted lines we need to
+    // remember current line
+    int mCurrentHighlightedLine;
+
+    // Matched lines and their highlighting, nullptr without filter
+    std::shared_ptr<const FilterResult> mFilterResult;
+};
+
+#endif // DOCUMENT_H
\ No newline at end of file
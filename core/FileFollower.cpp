@@ -0,0 +1,163 @@
+#include "FileFollower.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <algorithm>
+
+namespace
+{
+
+// Larger appends are read over several timer ticks,
+// so the GUI thread never decodes more than this at once
+constexpr qint64 kMaxReadBytes = 4 * 1024 * 1024;
+
+}
+
+FileFollower::FileFollower(QObject *parent)
+    : QObject(parent)
+    , mOffset(0)
+    , mEncoding(TextCodec::Encoding::Utf8)
+    , mHasPendingCarriageReturn(false)
+{
+    mReadTimer.setSingleShot(true);
+    mReadTimer.setInterval(kReadDelayMs);
+    connect(&mReadTimer, &QTimer::timeout, this, &FileFollower::readAppended);
+
+    connect(&mWatcher, &QFileSystemWatcher::fileChanged,
+            this, &FileFollower::onFileChanged);
+    connect(&mWatcher, &QFileSystemWatcher::directoryChanged,
+            this, &FileFollower::onDirectoryChanged);
+}
+
+void FileFollower::follow(const QString& filename, qint64 size, TextCodec::Encoding encoding)
+{
+    stop();
+    if (filename.isEmpty())
+    {
+        return;
+    }
+
+    mFilename = filename;
+    mOffset = size;
+    mEncoding = encoding;
+
+    // Directory tells when a rotated file is created again
+    mWatcher.addPath(filename);
+    mWatcher.addPath(QFileInfo(filename).absolutePath());
+
+    // File may have grown while it was loaded
+    mReadTimer.start();
+}
+
+void FileFollower::stop()
+{
+    mReadTimer.stop();
+    if (!mWatcher.files().isEmpty())
+    {
+        mWatcher.removePaths(mWatcher.files());
+    }
+    if (!mWatcher.directories().isEmpty())
+    {
+        mWatcher.removePaths(mWatcher.directories());
+    }
+
+    mFilename.clear();
+    mOffset = 0;
+    mPendingBytes.clear();
+    mHasPendingCarriageReturn = false;
+}
+
+void FileFollower::onFileChanged()
+{
+    // Watcher stops watching a file which was removed or renamed
+    if (!mWatcher.files().contains(mFilename))
+    {
+        if (QFileInfo::exists(mFilename))
+        {
+            mWatcher.addPath(mFilename);
+            emit fileReset();
+        }
+        return;
+    }
+
+    if (!mReadTimer.isActive())
+    {
+        mReadTimer.start();
+    }
+}
+
+void FileFollower::onDirectoryChanged()
+{
+    // Rotated file was created again
+    if (!mWatcher.files().contains(mFilename) && QFileInfo::exists(mFilename))
+    {
+        mWatcher.addPath(mFilename);
+        emit fileReset();
+    }
+}
+
+void FileFollower::readAppended()
+{
+    if (!isFollowing())
+    {
+        return;
+    }
+
+    QFile file(mFilename);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return;
+    }
+
+    const qint64 size = file.size();
+    if (size < mOffset)
+    {
+        emit fileReset();
+        return;
+    }
+    if (size == mOffset || !file.seek(mOffset))
+    {
+        return;
+    }
+
+    const bool isFirstRead = mOffset == 0;
+    QByteArray bytes = mPendingBytes + file.read(std::min(size - mOffset, kMaxReadBytes));
+    mOffset += bytes.size() - mPendingBytes.size();
+    if (mOffset < size)
+    {
+        mReadTimer.start();
+    }
+
+    // Nothing was loaded, the file starts with these bytes
+    if (isFirstRead)
+    {
+        int bomLength = 0;
+        mEncoding = TextCodec::detect(bytes, bomLength);
+        bytes.remove(0, bomLength);
+    }
+
+    const qsizetype length = TextCodec::completeLength(bytes, mEncoding);
+    mPendingBytes = bytes.mid(length);
+    bytes.truncate(length);
+
+    // Decoding turns \r\n into \n, except where reads split them
+    QString text = TextCodec::decode(bytes, mEncoding);
+    if (mHasPendingCarriageReturn)
+    {
+        if (!text.startsWith(u'\n'))
+        {
+            text.prepend(u'\r');
+        }
+        mHasPendingCarriageReturn = false;
+    }
+    if (text.endsWith(u'\r'))
+    {
+        text.chop(1);
+        mHasPendingCarriageReturn = true;
+    }
+
+    if (!text.isEmpty())
+    {
+        emit textAppended(text);
+    }
+}
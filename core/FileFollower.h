@@ -0,0 +1,65 @@
+#ifndef FILE_FOLLOWER_H
+#define FILE_FOLLOWER_H
+
+#include <QFileSystemWatcher>
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+#include <QTimer>
+
+#include "TextCodec.h"
+
+// Watches a file which other programs append to, like tail -f.
+// Only the bytes appended since the last read are read and decoded.
+// Change notifications are batched, so a burst of writes costs one read.
+//
+// Truncation and replacement of the file, e.g. by log rotation,
+// are reported as fileReset(), the file has to be loaded again then.
+class FileFollower : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    explicit FileFollower(QObject *parent = Q_NULLPTR);
+
+    // Follow the file, its first size bytes are already loaded.
+    // Appended bytes are decoded in the encoding the file was loaded
+    // with. If nothing was loaded, it is detected from the first bytes.
+    void follow(const QString& filename, qint64 size, TextCodec::Encoding encoding);
+    void stop();
+
+    bool isFollowing() const { return !mFilename.isEmpty(); }
+
+signals:
+
+    // Text appended to the file, line breaks are \n
+    void textAppended(const QString& text);
+
+    void fileReset();
+
+private slots:
+
+    void onFileChanged();
+    void onDirectoryChanged();
+    void readAppended();
+
+private:
+
+    QFileSystemWatcher mWatcher;
+    QTimer mReadTimer;
+
+    QString mFilename;
+    qint64 mOffset;
+
+    TextCodec::Encoding mEncoding;
+
+    // Appended bytes may end in the middle of a character or between
+    // \r and \n, the rest of it comes with the next read
+    QByteArray mPendingBytes;
+    bool mHasPendingCarriageReturn;
+
+    static constexpr int kReadDelayMs = 100;
+};
+
+#endif // FILE_FOLLOWER_H
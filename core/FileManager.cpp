@@ -0,0 +1,218 @@
+#include "FileManager.h"
+#include "TextCodec.h"
+#include "Trace.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QException>
+#include <QDebug>
+#include <algorithm>
+
+namespace
+{
+
+constexpr qint64 kFirstChunkBytes = 64 * 1024;
+constexpr qint64 kChunkBytes = 4 * 1024 * 1024;
+
+// Encoding is guessed from this many bytes at the beginning
+constexpr qsizetype kDetectBytes = 64 * 1024;
+
+// Characters encoded at once when saving
+constexpr qsizetype kSaveChunkLength = 1024 * 1024;
+
+void writeUtf8(QSaveFile& file, QStringView text)
+{
+    const QByteArray bytes = TextCodec::encodeUtf8(text);
+    if (file.write(bytes) != bytes.size())
+    {
+        throw std::runtime_error(file.errorString().toStdString());
+    }
+}
+
+}
+
+QString FileManager::load(const QString &filename)
+{
+    if (filename.isEmpty())
+    {
+        return "";
+    }
+
+    Trace::Scope scope("file.load");
+
+    QString text;
+    loadChunks(
+        filename,
+        [&text, &scope](const QString& chunk, qint64, qint64 size)
+        {
+            // Every byte is one character at most
+            if (text.isEmpty())
+            {
+                text.reserve(size);
+                scope.setCounter("bytes", size);
+            }
+            text += chunk;
+        },
+        []() { return false; });
+    return text;
+}
+
+bool FileManager::loadChunks(
+    const QString &filename,
+    const std::function<void(const QString& chunk, qint64 bytesRead, qint64 size)>& chunkReady,
+    const std::function<bool()>& isCancelled,
+    TextCodec::Encoding* encoding)
+{
+    // Read, not mapped: a log may be truncated while it is loaded,
+    // and mapped bytes past its new end crash with SIGBUS, while
+    // a read just ends early
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "FileManager::loadChunks: failed to open" << filename << file.errorString();
+        return false;
+    }
+
+    // Bytes written after the file was opened are left to the follower
+    const qint64 size = file.size();
+
+    TextCodec::Encoding fileEncoding = TextCodec::Encoding::Utf8;
+    bool isDetected = false;
+    bool isFirstChunk = true;
+    bool atEnd = false;
+    qint64 bytesRead = 0;
+    qint64 chunkBytes = kFirstChunkBytes;
+
+    // Beginning of a line which did not fit into the previous chunk
+    QByteArray bytes;
+
+    while (!atEnd && !isCancelled())
+    {
+        const qsizetype pending = bytes.size();
+        const qint64 maxSize = std::min(chunkBytes, size - bytesRead);
+        bytes.resize(pending + maxSize);
+        const qint64 n = maxSize > 0 ? file.read(bytes.data() + pending, maxSize) : 0;
+        bytes.resize(pending + std::max<qint64>(n, 0));
+        bytesRead += std::max<qint64>(n, 0);
+        atEnd = n <= 0 || bytesRead >= size;
+        chunkBytes = kChunkBytes;
+
+        if (!isDetected)
+        {
+            int bomLength = 0;
+            fileEncoding = TextCodec::detect(
+                QByteArrayView(bytes).left(std::min<qsizetype>(bytes.size(), kDetectBytes)),
+                bomLength);
+            bytes.remove(0, bomLength);
+            isDetected = true;
+            if (encoding != nullptr)
+            {
+                *encoding = fileEncoding;
+            }
+        }
+
+        // Whole lines up to the chunk size, a longer line is read on.
+        // Bytes carried from before hold no line break.
+        qsizetype lineEnd = bytes.size();
+        if (!atEnd)
+        {
+            const qsizetype searched = pending & ~qsizetype(1);
+            lineEnd = TextCodec::lastLineEnd(QByteArrayView(bytes).mid(searched), fileEncoding);
+            if (lineEnd == 0)
+            {
+                continue;
+            }
+            lineEnd += searched;
+        }
+
+        QString chunk;
+        {
+            Trace::Scope scope("file.decodeChunk");
+            scope.setCounter("bytes", lineEnd);
+            chunk = TextCodec::decode(QByteArrayView(bytes).left(lineEnd), fileEncoding);
+        }
+        bytes.remove(0, lineEnd);
+
+        // Line break after the chunk begins the next one. A \r at the
+        // very end belongs to the line break of the last line.
+        if (atEnd ? chunk.endsWith(u'\r') : chunk.endsWith(u'\n'))
+        {
+            chunk.chop(1);
+        }
+        if (!isFirstChunk)
+        {
+            chunk.prepend(u'\n');
+        }
+        isFirstChunk = false;
+
+        chunkReady(chunk, bytesRead, size);
+    }
+
+    return true;
+}
+
+void FileManager::save(const QString &filename, const QString &text)
+{
+    Trace::Scope scope("file.save");
+    scope.setCounter("characters", text.size());
+
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        throw std::runtime_error(file.errorString().toStdString());
+    }
+
+    for (qsizetype i = 0; i < text.size(); )
+    {
+        qsizetype length = std::min(kSaveChunkLength, text.size() - i);
+
+        // Surrogate pair is encoded as one character
+        if (i + length < text.size() && text[i + length - 1].isHighSurrogate())
+        {
+            --length;
+        }
+
+        writeUtf8(file, QStringView(text).mid(i, length));
+        i += length;
+    }
+
+    if (!file.commit())
+    {
+        throw std::runtime_error(file.errorString().toStdString());
+    }
+}
+
+void FileManager::save(const QString &filename, const QStringList &lines)
+{
+    Trace::Scope scope("file.save");
+    scope.setCounter("lines", lines.size());
+
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        throw std::runtime_error(file.errorString().toStdString());
+    }
+
+    // Whole lines are gathered, so no surrogate pair is split
+    QString chunk;
+    chunk.reserve(kSaveChunkLength);
+    for (qsizetype i = 0; i < lines.size(); ++i)
+    {
+        if (i > 0)
+        {
+            chunk += u'\n';
+        }
+        chunk += lines[i];
+
+        if (chunk.size() >= kSaveChunkLength)
+        {
+            writeUtf8(file, chunk);
+            chunk.resize(0);
+        }
+    }
+    writeUtf8(file, chunk);
+
+    if (!file.commit())
+    {
+        throw std::runtime_error(file.errorString().toStdString());
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef FILE_MANAGER_H
+#define FILE_MANAGER_H
+
+#include <QString>
+#include <QStringList>
+#include <functional>
+
+#include "TextCodec.h"
+
+namespace FileManager
+{
+
+// Whole text of the file, read the same way as by loadChunks()
+QString load(const QString &filename);
+
+// Decode the file in chunks of whole lines and pass each of them to
+// chunkReady together with bytes read so far and the file size.
+// Chunks after the first one begin with the line break which separates
+// them from the previous chunk, so appending them gives the whole text.
+// The first chunk is small, so the beginning of a file shows up at once.
+// If encoding is set, it gets the encoding of the file before the first
+// chunk is passed on. Returns false if the file could not be opened.
+bool loadChunks(
+    const QString &filename,
+    const std::function<void(const QString& chunk, qint64 bytesRead, qint64 size)>& chunkReady,
+    const std::function<bool()>& isCancelled,
+    TextCodec::Encoding* encoding = nullptr);
+
+// Encode and write text in chunks to a temporary file which replaces
+// the file only when all of it is written, so a failed or interrupted
+// save leaves the old file as it was. Throws std::runtime_error.
+void save(const QString &filename, const QString &text);
+
+// Same for lines joined with \n
+void save(const QString &filename, const QStringList &lines);
+
+};
+
+#endif // FILE_MANAGER_H
@@ -0,0 +1,89 @@
+#include "FilterQuery.h"
+
+FilterQuery::FilterQuery(const QString& filter)
+    : mItems(filter.split(" ", Qt::SkipEmptyParts))
+    , mPrefilterItem(-1)
+{
+    mNeedles.reserve(mItems.size());
+    for (const QString& item : std::as_const(mItems))
+    {
+        mFoldedItems.append(TextBuffer::foldCase(item));
+
+        const QString& foldedItem = mFoldedItems.constLast();
+        if (StringSearch::isAscii(foldedItem))
+        {
+            mNeedles.emplace_back(StringSearch::AsciiNeedle(foldedItem));
+        }
+        else
+        {
+            mNeedles.emplace_back(std::nullopt);
+        }
+    }
+
+    int rarestItem = 0;
+    int maxRarity = -1;
+    for (int i = 0; i < mItems.size(); ++i)
+    {
+        const int itemRarity = rarity(mItems[i]);
+        if (itemRarity > maxRarity)
+        {
+            rarestItem = i;
+            maxRarity = itemRarity;
+        }
+    }
+
+    if (rarestItem != 0)
+    {
+        mPrefilterItem = rarestItem;
+    }
+}
+
+int FilterQuery::rarity(const QString& item)
+{
+    // Letters which are the most frequent in English text and logs
+    static const QString commonLetters = QStringLiteral("etaoinsrhldcu");
+
+    int result = 0;
+    for (QChar c : item)
+    {
+        if (c.unicode() >= 0x80)
+        {
+            result += 4;
+        }
+        else if (commonLetters.contains(c, Qt::CaseInsensitive))
+        {
+            result += 1;
+        }
+        else if (c.isLetterOrNumber())
+        {
+            result += 2;
+        }
+        else
+        {
+            result += 3;
+        }
+    }
+    return result;
+}
+
+bool FilterQuery::mayMatch(QStringView foldedLine, bool isLineAscii) const
+{
+    return mPrefilterItem == -1
+        || indexOf(mPrefilterItem, foldedLine, 0, isLineAscii) != -1;
+}
+
+qsizetype FilterQuery::indexOf(
+    int item,
+    QStringView foldedLine,
+    qsizetype from,
+    bool isLineAscii) const
+{
+    const std::optional<StringSearch::AsciiNeedle>& needle = mNeedles[item];
+    if (isLineAscii && needle)
+    {
+        return needle->indexIn(foldedLine, from);
+    }
+
+    // Both sides are folded already
+    return foldedLine.indexOf(mFoldedItems[item], from, Qt::CaseSensitive);
+}
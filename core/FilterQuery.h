@@ -0,0 +1,56 @@
+#ifndef FILTER_QUERY_H
+#define FILTER_QUERY_H
+
+#include "StringSearch.h"
+#include "TextBuffer.h"
+
+#include <QStringList>
+#include <optional>
+#include <vector>
+
+// Filter text compiled once per filter pass.
+// Items are split, folded and given search tables up front,
+// so matching a line does not allocate anything.
+// Lines are searched in their folded form, see TextBuffer.
+class FilterQuery
+{
+public:
+
+    explicit FilterQuery(const QString& filter);
+
+    const QStringList& items() const { return mItems; }
+    int itemCount() const { return mItems.size(); }
+    int itemLength(int item) const { return mItems[item].length(); }
+    const QString& foldedItem(int item) const { return mFoldedItems[item]; }
+
+    // Cheap check before the in-order match: false if the line
+    // misses the item least likely to appear in text
+    bool mayMatch(QStringView foldedLine, bool isLineAscii) const;
+
+    // Position of the item in the folded line
+    // Same as line.indexOf(items()[item], from, Qt::CaseInsensitive)
+    // on the original line
+    qsizetype indexOf(
+        int item,
+        QStringView foldedLine,
+        qsizetype from,
+        bool isLineAscii) const;
+
+private:
+
+    // Rough estimate how unlikely item is to appear in text.
+    // Longer items and less common characters score higher.
+    static int rarity(const QString& item);
+
+    QStringList mItems;
+    QStringList mFoldedItems;
+
+    // Set for ASCII items only
+    std::vector<std::optional<StringSearch::AsciiNeedle>> mNeedles;
+
+    // Item checked by mayMatch(), -1 if the in-order match
+    // starts with the rarest item anyway
+    int mPrefilterItem;
+};
+
+#endif // FILTER_QUERY_H
@@ -0,0 +1,122 @@
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+
+// Encoding is guessed from this many bytes at the beginning
+constexpr qint64 kDetectBytes = 64 * 1024;
+
+}
+
+MappedFile::MappedFile(const QString& filename)
+    : mFile(filename)
+    , mIsOpen(false)
+    , mData(nullptr)
+    , mSize(0)
+    , mFileSize(0)
+    , mEncoding(TextCodec::Encoding::Utf8)
+{
+    if (!mFile.open(QIODevice::ReadOnly))
+    {
+        return;
+    }
+    mIsOpen = true;
+
+    mSize = mFile.size();
+    if (mSize > 0)
+    {
+        mData = reinterpret_cast<const char*>(mFile.map(0, mSize));
+    }
+
+    if (mData == nullptr)
+    {
+        mReadData = mFile.readAll();
+        mData = mReadData.constData();
+        mSize = mReadData.size();
+    }
+
+    mFileSize = mSize;
+
+    int bomLength = 0;
+    mEncoding = TextCodec::detect(
+        QByteArrayView(mData, std::min(mSize, kDetectBytes)),
+        bomLength);
+
+    if (mEncoding == TextCodec::Encoding::Utf16LE
+        || mEncoding == TextCodec::Encoding::Utf16BE)
+    {
+        const QString text = TextCodec::decode(
+            QByteArrayView(mData + bomLength, mSize - bomLength),
+            mEncoding);
+        mReadData = TextCodec::encodeUtf8(text);
+        mData = mReadData.constData();
+        mSize = mReadData.size();
+        mEncoding = TextCodec::Encoding::Utf8;
+        bomLength = 0;
+    }
+
+    findLineStarts(bomLength);
+}
+
+void MappedFile::findLineStarts(qint64 start)
+{
+    // Rough guess to avoid most reallocations, lines of logs
+    // are rarely shorter than this
+    mLineStarts.reserve(mSize / 64 + 2);
+    mLineStarts.push_back(start);
+
+    const char* end = mData + mSize;
+    for (const char* p = mData + start; p < end; )
+    {
+        const char* lineBreak =
+            static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (lineBreak == nullptr)
+        {
+            break;
+        }
+        p = lineBreak + 1;
+        mLineStarts.push_back(p - mData);
+    }
+
+    mLineStarts.push_back(mSize + 1);
+}
+
+QByteArrayView MappedFile::lineBytes(int lineNum) const
+{
+    const qint64 start = mLineStarts[lineNum];
+    qint64 length = mLineStarts[lineNum + 1] - 1 - start;
+    if (length > 0 && mData[start + length - 1] == '\r')
+    {
+        --length;
+    }
+    return QByteArrayView(mData + start, length);
+}
+
+bool MappedFile::isTruncated() const
+{
+    // Bytes which were read or converted are in memory
+    return mReadData.isNull() && mFile.size() < mFileSize;
+}
+
+QString MappedFile::text(int firstLine, int count) const
+{
+    if (count <= 0)
+    {
+        return QString();
+    }
+
+    // Lines are decoded in one pass over their bytes, the decoder
+    // drops the \r of every \r\n between them. A \r at the very end
+    // belongs to the line break of the last line.
+    const qint64 begin = mLineStarts[firstLine];
+    qint64 end = mLineStarts[firstLine + count] - 1;
+    if (end > begin && mData[end - 1] == '\r')
+    {
+        --end;
+    }
+
+    return TextCodec::decode(QByteArrayView(mData + begin, end - begin), mEncoding);
+}
@@ -0,0 +1,79 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QFile>
+#include <QString>
+#include <vector>
+
+#include "TextCodec.h"
+
+// Read-only file mapped into memory, with the start of every line.
+// Opening costs one newline scan over the mapped bytes. Lines are
+// decoded only when they are asked for, a block at a time, so memory
+// holds little more than the mapped pages. The filter command reads
+// regular files this way.
+//
+// Mapped bytes past the end of a file which was truncated meanwhile
+// crash with SIGBUS when they are read. Readers check isTruncated()
+// before every block, which leaves a short window, so the editor reads
+// files instead: the logs it follows are truncated when rotated.
+//
+// Line breaks are \n or \r\n, like QFile::Text reads them.
+// Encoding is taken from the byte order mark, which is skipped.
+// Without one, the file is UTF-8 if its beginning is valid UTF-8,
+// Latin-1 otherwise. UTF-16 files are converted to UTF-8 in memory
+// when they are opened, so lines can be found by their \n bytes.
+// Files which cannot be mapped, e.g. pipes, are read into memory.
+class MappedFile
+{
+public:
+
+    explicit MappedFile(const QString& filename);
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool isOpen() const { return mIsOpen; }
+    QString errorString() const { return mFile.errorString(); }
+
+    // Size of the file in bytes
+    qint64 size() const { return mFileSize; }
+
+    // Text after the last line break is a line too, possibly empty,
+    // the same way QTextDocument counts blocks
+    int lineCount() const { return static_cast<int>(mLineStarts.size()) - 1; }
+
+    TextCodec::Encoding encoding() const { return mEncoding; }
+
+    // True if the file is shorter now than when it was mapped
+    bool isTruncated() const;
+
+    // Bytes of the line without its line break
+    QByteArrayView lineBytes(int lineNum) const;
+
+    // Lines [firstLine, firstLine + count) joined with \n
+    QString text(int firstLine, int count) const;
+
+private:
+
+    void findLineStarts(qint64 start);
+
+    QFile mFile;
+    bool mIsOpen;
+
+    // Mapped bytes, or mReadData if the file could not be mapped
+    const char* mData;
+    qint64 mSize;
+    qint64 mFileSize;
+    QByteArray mReadData;
+
+    TextCodec::Encoding mEncoding;
+
+    // Line N starts at mLineStarts[N], one extra element is the end
+    // of the text plus one, as if the text ended with a line break
+    std::vector<qint64> mLineStarts;
+};
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,87 @@
+#include "MatchList.h"
+
+#include <algorithm>
+
+MatchList::MatchList(std::pmr::memory_resource* resource)
+    : mLines(resource)
+    , mAreaStarts(1, 0, resource)
+    , mAreas(resource)
+{
+}
+
+void MatchList::reserve(int lineCount, int areaCount)
+{
+    mLines.reserve(lineCount);
+    mAreaStarts.reserve(lineCount + 1);
+    mAreas.reserve(areaCount);
+}
+
+void MatchList::clear()
+{
+    mLines.clear();
+    mAreaStarts.assign(1, 0);
+    mAreas.clear();
+}
+
+void MatchList::append(int lineNum, const std::pmr::vector<HighlightArea>& areas)
+{
+    mLines.push_back(lineNum);
+    mAreas.insert(mAreas.end(), areas.begin(), areas.end());
+    mAreaStarts.push_back(areaCount());
+}
+
+void MatchList::append(const MatchList& other)
+{
+    append(other, other.size());
+}
+
+void MatchList::append(const MatchList& other, int count)
+{
+    const int offset = areaCount();
+
+    mLines.insert(mLines.end(), other.mLines.begin(), other.mLines.begin() + count);
+    mAreas.insert(
+        mAreas.end(),
+        other.mAreas.begin(),
+        other.mAreas.begin() + other.mAreaStarts[count]);
+    for (int n = 1; n <= count; ++n)
+    {
+        mAreaStarts.push_back(other.mAreaStarts[n] + offset);
+    }
+}
+
+void MatchList::truncate(int count)
+{
+    mAreas.erase(mAreas.begin() + mAreaStarts[count], mAreas.end());
+    mLines.erase(mLines.begin() + count, mLines.end());
+    mAreaStarts.erase(mAreaStarts.begin() + count + 1, mAreaStarts.end());
+}
+
+size_t MatchList::memoryUsage() const
+{
+    return mLines.capacity() * sizeof(int)
+        + mAreaStarts.capacity() * sizeof(int)
+        + mAreas.capacity() * sizeof(HighlightArea);
+}
+
+int MatchList::indexOf(int lineNum) const
+{
+    auto it = std::lower_bound(mLines.begin(), mLines.end(), lineNum);
+    if (it == mLines.end() || *it != lineNum)
+    {
+        return -1;
+    }
+    return static_cast<int>(it - mLines.begin());
+}
+
+int MatchList::nextIndex(int lineNum) const
+{
+    auto it = std::upper_bound(mLines.begin(), mLines.end(), lineNum);
+    return static_cast<int>(it - mLines.begin());
+}
+
+int MatchList::previousIndex(int lineNum) const
+{
+    auto it = std::lower_bound(mLines.begin(), mLines.end(), lineNum);
+    return static_cast<int>(it - mLines.begin()) - 1;
+}
@@ -0,0 +1,81 @@
+#ifndef MATCH_LIST_H
+#define MATCH_LIST_H
+
+#include <memory_resource>
+#include <vector>
+
+// Area to highlight in the line
+// Begin and end represents values since line start
+struct HighlightArea
+{
+    HighlightArea(int begin, int end)
+        : begin(begin)
+        , end(end)
+    {
+    }
+
+    int begin;
+    int end;
+};
+
+// Matched lines of a filter in three flat arrays:
+// ascending line numbers, offset of the first area of every line,
+// and the highlight areas of all lines one after another.
+// Match n is line lineAt(n) with areas [areaBegin(n), areaEnd(n)).
+//
+// The arrays are allocated from the given memory resource, which lets
+// a filter pass keep all of its matches in one arena.
+class MatchList
+{
+public:
+
+    explicit MatchList(
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    void reserve(int lineCount, int areaCount);
+    void clear();
+
+    // Lines must be appended in ascending order
+    void append(int lineNum, const std::pmr::vector<HighlightArea>& areas);
+    void append(const MatchList& other);
+
+    // First count matches of other
+    void append(const MatchList& other, int count);
+
+    // Keep only the first count matches
+    void truncate(int count);
+
+    int size() const { return static_cast<int>(mLines.size()); }
+    bool isEmpty() const { return mLines.empty(); }
+    int areaCount() const { return static_cast<int>(mAreas.size()); }
+
+    // Bytes allocated for the arrays
+    size_t memoryUsage() const;
+
+    int lineAt(int n) const { return mLines[n]; }
+    const HighlightArea* areaBegin(int n) const { return mAreas.data() + mAreaStarts[n]; }
+    const HighlightArea* areaEnd(int n) const { return mAreas.data() + mAreaStarts[n + 1]; }
+
+    const std::pmr::vector<int>& lines() const { return mLines; }
+
+    // Match of the line, -1 if the line did not match
+    int indexOf(int lineNum) const;
+
+    // First match after the line, size() if there is none
+    int nextIndex(int lineNum) const;
+
+    // Last match before the line, -1 if there is none
+    int previousIndex(int lineNum) const;
+
+private:
+
+    std::pmr::vector<int> mLines;
+
+    // Areas of match n start at mAreaStarts[n], one extra
+    // element at the end, so areaEnd(n) needs no special case
+    std::pmr::vector<int> mAreaStarts;
+
+    std::pmr::vector<HighlightArea> mAreas;
+};
+
+#endif // MATCH_LIST_H
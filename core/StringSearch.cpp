@@ -0,0 +1,374 @@
+#include "StringSearch.h"
+
+#include <QVarLengthArray>
+#include <QtAlgorithms>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define STRING_SEARCH_SSE2
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang only emit AVX2 instructions in functions marked for it,
+// MSVC accepts AVX2 intrinsics anywhere
+#if defined(STRING_SEARCH_SSE2) && (defined(__GNUC__) || defined(__clang__))
+#define STRING_SEARCH_AVX2 __attribute__((target("avx2")))
+#else
+#define STRING_SEARCH_AVX2
+#endif
+
+namespace
+{
+
+// Shorter needles skip too little for Horspool to beat the SIMD kernel
+constexpr qsizetype kMinHorspoolLength = 16;
+
+using IndexOfAsciiFunction = qsizetype (*)(
+    const char16_t* haystack,
+    qsizetype haystackLength,
+    const char16_t* foldedNeedle,
+    qsizetype needleLength,
+    qsizetype from);
+
+inline char16_t foldAscii(char16_t c)
+{
+    return (c >= u'A' && c <= u'Z') ? char16_t(c | 0x20) : c;
+}
+
+inline bool equalsFolded(
+    const char16_t* text,
+    const char16_t* foldedNeedle,
+    qsizetype length)
+{
+    for (qsizetype i = 0; i < length; ++i)
+    {
+        if (foldAscii(text[i]) != foldedNeedle[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool isAsciiScalar(const char16_t* text, qsizetype length)
+{
+    char16_t bits = 0;
+    for (qsizetype i = 0; i < length; ++i)
+    {
+        bits |= text[i];
+    }
+    return (bits & 0xff80) == 0;
+}
+
+qsizetype indexOfAsciiScalar(
+    const char16_t* haystack,
+    qsizetype haystackLength,
+    const char16_t* foldedNeedle,
+    qsizetype needleLength,
+    qsizetype from)
+{
+    const char16_t first = foldedNeedle[0];
+    for (qsizetype i = from; i + needleLength <= haystackLength; ++i)
+    {
+        if (foldAscii(haystack[i]) == first
+            && equalsFolded(haystack + i + 1, foldedNeedle + 1, needleLength - 1))
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+#ifdef STRING_SEARCH_SSE2
+
+// Lower case A-Z, other characters stay as they are.
+// Only valid for ASCII: characters above 0x7fff compare as negative.
+inline __m128i foldAscii(__m128i chars)
+{
+    const __m128i isUpper = _mm_and_si128(
+        _mm_cmpgt_epi16(chars, _mm_set1_epi16(u'A' - 1)),
+        _mm_cmplt_epi16(chars, _mm_set1_epi16(u'Z' + 1)));
+    return _mm_or_si128(chars, _mm_and_si128(isUpper, _mm_set1_epi16(0x20)));
+}
+
+bool isAsciiSse2(const char16_t* text, qsizetype length)
+{
+    __m128i bits = _mm_setzero_si128();
+    qsizetype i = 0;
+    for (; i + 8 <= length; i += 8)
+    {
+        bits = _mm_or_si128(
+            bits,
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i)));
+    }
+
+    const __m128i nonAscii = _mm_and_si128(bits, _mm_set1_epi16(short(0xff80)));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi16(nonAscii, _mm_setzero_si128())) != 0xffff)
+    {
+        return false;
+    }
+    return isAsciiScalar(text + i, length - i);
+}
+
+// Compare first and last needle characters against 8 candidate
+// positions at once, then verify the middle of the candidates.
+qsizetype indexOfAsciiSse2(
+    const char16_t* haystack,
+    qsizetype haystackLength,
+    const char16_t* foldedNeedle,
+    qsizetype needleLength,
+    qsizetype from)
+{
+    const __m128i first = _mm_set1_epi16(short(foldedNeedle[0]));
+    const __m128i last = _mm_set1_epi16(short(foldedNeedle[needleLength - 1]));
+    const qsizetype positions = haystackLength - needleLength + 1;
+
+    qsizetype i = from;
+    for (; i + 8 <= positions; i += 8)
+    {
+        const __m128i firstChars = foldAscii(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + i)));
+        const __m128i lastChars = foldAscii(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + i + needleLength - 1)));
+
+        // Two bits per character
+        quint32 mask = _mm_movemask_epi8(_mm_and_si128(
+            _mm_cmpeq_epi16(firstChars, first),
+            _mm_cmpeq_epi16(lastChars, last)));
+
+        while (mask != 0)
+        {
+            const qsizetype pos = i + qCountTrailingZeroBits(mask) / 2;
+            if (needleLength <= 2
+                || equalsFolded(haystack + pos + 1, foldedNeedle + 1, needleLength - 2))
+            {
+                return pos;
+            }
+            mask &= mask - 1;
+            mask &= mask - 1;
+        }
+    }
+
+    return indexOfAsciiScalar(haystack, haystackLength, foldedNeedle, needleLength, i);
+}
+
+STRING_SEARCH_AVX2
+inline __m256i foldAscii(__m256i chars)
+{
+    const __m256i isUpper = _mm256_and_si256(
+        _mm256_cmpgt_epi16(chars, _mm256_set1_epi16(u'A' - 1)),
+        _mm256_cmpgt_epi16(_mm256_set1_epi16(u'Z' + 1), chars));
+    return _mm256_or_si256(chars, _mm256_and_si256(isUpper, _mm256_set1_epi16(0x20)));
+}
+
+STRING_SEARCH_AVX2
+bool isAsciiAvx2(const char16_t* text, qsizetype length)
+{
+    __m256i bits = _mm256_setzero_si256();
+    qsizetype i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+        bits = _mm256_or_si256(
+            bits,
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i)));
+    }
+
+    const __m256i nonAscii = _mm256_and_si256(bits, _mm256_set1_epi16(short(0xff80)));
+    if (!_mm256_testz_si256(nonAscii, nonAscii))
+    {
+        return false;
+    }
+    return isAsciiSse2(text + i, length - i);
+}
+
+STRING_SEARCH_AVX2
+qsizetype indexOfAsciiAvx2(
+    const char16_t* haystack,
+    qsizetype haystackLength,
+    const char16_t* foldedNeedle,
+    qsizetype needleLength,
+    qsizetype from)
+{
+    const __m256i first = _mm256_set1_epi16(short(foldedNeedle[0]));
+    const __m256i last = _mm256_set1_epi16(short(foldedNeedle[needleLength - 1]));
+    const qsizetype positions = haystackLength - needleLength + 1;
+
+    qsizetype i = from;
+    for (; i + 16 <= positions; i += 16)
+    {
+        const __m256i firstChars = foldAscii(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(haystack + i)));
+        const __m256i lastChars = foldAscii(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(haystack + i + needleLength - 1)));
+
+        // Two bits per character
+        quint32 mask = quint32(_mm256_movemask_epi8(_mm256_and_si256(
+            _mm256_cmpeq_epi16(firstChars, first),
+            _mm256_cmpeq_epi16(lastChars, last))));
+
+        while (mask != 0)
+        {
+            const qsizetype pos = i + qCountTrailingZeroBits(mask) / 2;
+            if (needleLength <= 2
+                || equalsFolded(haystack + pos + 1, foldedNeedle + 1, needleLength - 2))
+            {
+                return pos;
+            }
+            mask &= mask - 1;
+            mask &= mask - 1;
+        }
+    }
+
+    return indexOfAsciiSse2(haystack, haystackLength, foldedNeedle, needleLength, i);
+}
+
+bool cpuHasAvx2()
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+    {
+        return false;
+    }
+
+    // AVX registers must be enabled by the OS as well
+    __cpuid(info, 1);
+    const bool hasOsxsave = (info[2] & (1 << 27)) != 0;
+    const bool hasAvx = (info[2] & (1 << 28)) != 0;
+    if (!hasOsxsave || !hasAvx || (_xgetbv(0) & 0x6) != 0x6)
+    {
+        return false;
+    }
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return false;
+#endif
+}
+
+const bool cpuAvx2 = cpuHasAvx2();
+
+// Changed only by StringSearch::setAvx2Enabled()
+bool hasAvx2 = cpuAvx2;
+IndexOfAsciiFunction indexOfAscii = hasAvx2 ? indexOfAsciiAvx2 : indexOfAsciiSse2;
+
+bool isAsciiText(const char16_t* text, qsizetype length)
+{
+    return hasAvx2 ? isAsciiAvx2(text, length) : isAsciiSse2(text, length);
+}
+
+#else
+
+const IndexOfAsciiFunction indexOfAscii = indexOfAsciiScalar;
+
+bool isAsciiText(const char16_t* text, qsizetype length)
+{
+    return isAsciiScalar(text, length);
+}
+
+#endif
+
+}
+
+void StringSearch::setAvx2Enabled(bool isEnabled)
+{
+#ifdef STRING_SEARCH_SSE2
+    hasAvx2 = isEnabled && cpuAvx2;
+    indexOfAscii = hasAvx2 ? indexOfAsciiAvx2 : indexOfAsciiSse2;
+#else
+    Q_UNUSED(isEnabled);
+#endif
+}
+
+bool StringSearch::isAscii(QStringView text)
+{
+    return isAsciiText(text.utf16(), text.size());
+}
+
+qsizetype StringSearch::indexOf(
+    QStringView haystack,
+    QStringView needle,
+    qsizetype from,
+    bool asciiOnly)
+{
+    if (!asciiOnly || needle.isEmpty() || from < 0)
+    {
+        return haystack.indexOf(needle, from, Qt::CaseInsensitive);
+    }
+
+    if (haystack.size() - from < needle.size())
+    {
+        return -1;
+    }
+
+    QVarLengthArray<char16_t, 64> foldedNeedle(needle.size());
+    for (qsizetype i = 0; i < needle.size(); ++i)
+    {
+        foldedNeedle[i] = foldAscii(needle.utf16()[i]);
+    }
+
+    return indexOfAscii(
+        haystack.utf16(),
+        haystack.size(),
+        foldedNeedle.constData(),
+        needle.size(),
+        from);
+}
+
+StringSearch::AsciiNeedle::AsciiNeedle(QStringView needle)
+    : mFolded(needle.size())
+{
+    for (qsizetype i = 0; i < needle.size(); ++i)
+    {
+        mFolded[i] = foldAscii(needle.utf16()[i]);
+    }
+
+    const qsizetype length = needle.size();
+    mShift.fill(length);
+    for (qsizetype i = 0; i + 1 < length; ++i)
+    {
+        mShift[mFolded[i] & 0x7f] = length - 1 - i;
+    }
+}
+
+qsizetype StringSearch::AsciiNeedle::indexIn(
+    QStringView haystack,
+    qsizetype from) const
+{
+    const qsizetype length = static_cast<qsizetype>(mFolded.size());
+    if (length == 0 || from < 0)
+    {
+        return haystack.indexOf(
+            QStringView(mFolded.data(), length), from, Qt::CaseInsensitive);
+    }
+
+    if (haystack.size() - from < length)
+    {
+        return -1;
+    }
+
+    const char16_t* text = haystack.utf16();
+    if (length < kMinHorspoolLength)
+    {
+        return indexOfAscii(text, haystack.size(), mFolded.data(), length, from);
+    }
+
+    const char16_t last = mFolded[length - 1];
+    for (qsizetype i = from; i + length <= haystack.size(); )
+    {
+        const char16_t c = foldAscii(text[i + length - 1]);
+        if (c == last && equalsFolded(text + i, mFolded.data(), length - 1))
+        {
+            return i;
+        }
+        i += mShift[c & 0x7f];
+    }
+    return -1;
+}
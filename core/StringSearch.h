@@ -0,0 +1,52 @@
+#ifndef STRING_SEARCH_H
+#define STRING_SEARCH_H
+
+#include <QStringView>
+#include <array>
+#include <vector>
+
+// Case-insensitive substring search used by the filter.
+// When both strings are ASCII only, search runs on SSE2 or AVX2
+// (chosen at runtime, with a scalar fallback on other CPUs).
+// Anything else goes through QStringView::indexOf, so results
+// are always the same as with Qt::CaseInsensitive.
+namespace StringSearch
+{
+
+// AVX2 is used where the CPU has it. Turned off, SSE2 is used
+// instead, e.g. so tests cover both. Not while searches run.
+void setAvx2Enabled(bool isEnabled);
+
+// True if every character of text is in 7-bit ASCII range
+bool isAscii(QStringView text);
+
+// Same as haystack.indexOf(needle, from, Qt::CaseInsensitive)
+// Pass asciiOnly = true only if both haystack and needle are ASCII
+qsizetype indexOf(
+    QStringView haystack,
+    QStringView needle,
+    qsizetype from,
+    bool asciiOnly);
+
+// ASCII needle folded once for searching it in many lines.
+// Long needles are searched with Horspool skips,
+// short ones with the SIMD kernel.
+class AsciiNeedle
+{
+public:
+    explicit AsciiNeedle(QStringView needle);
+
+    // Same as haystack.indexOf(needle, from, Qt::CaseInsensitive)
+    // Haystack must be ASCII
+    qsizetype indexIn(QStringView haystack, qsizetype from) const;
+
+private:
+    std::vector<char16_t> mFolded;
+
+    // Horspool shift for every folded ASCII character
+    std::array<qsizetype, 128> mShift;
+};
+
+};
+
+#endif // STRING_SEARCH_H
@@ -0,0 +1,264 @@
+#include "TextBuffer.h"
+#include "StringSearch.h"
+
+#include <QChar>
+
+#include <algorithm>
+#include <atomic>
+
+namespace
+{
+
+// Appending to a snapshot copies its last segment, so segments are
+// kept small enough for that to cost little next to the appended text
+constexpr qsizetype kSegmentLength = 64 * 1024;
+
+quint64 nextRevision()
+{
+    static std::atomic<quint64> revision{0};
+    return ++revision;
+}
+
+}
+
+TextBuffer::TextBuffer()
+    : mLineCount(0)
+    , mLength(0)
+    , mRevision(nextRevision())
+{
+}
+
+void TextBuffer::appendLine(QStringView line)
+{
+    Segment& segment = segmentForAppend();
+    const qsizetype start = segment.foldedText.size();
+    appendFolded(segment.foldedText, line);
+    segment.lineEnds.push_back(segment.foldedText.size());
+    segment.asciiLines.push_back(
+        StringSearch::isAscii(QStringView(segment.foldedText).mid(start)) ? 1 : 0);
+
+    ++mLineCount;
+    mLength += line.size();
+}
+
+void TextBuffer::appendToLastLine(QStringView text)
+{
+    Segment& segment = lastSegment();
+    const qsizetype start = segment.foldedText.size();
+    appendFolded(segment.foldedText, text);
+    segment.lineEnds.back() = segment.foldedText.size();
+
+    if (segment.asciiLines.back() != 0
+        && !StringSearch::isAscii(QStringView(segment.foldedText).mid(start)))
+    {
+        segment.asciiLines.back() = 0;
+    }
+
+    mLength += text.size();
+}
+
+QStringView TextBuffer::foldedLine(int lineNum) const
+{
+    const int index = segmentOf(lineNum);
+    return mSegments[index]->line(lineNum - mSegmentStarts[index]);
+}
+
+bool TextBuffer::isFoldedLineAscii(int lineNum) const
+{
+    const int index = segmentOf(lineNum);
+    return mSegments[index]->asciiLines[lineNum - mSegmentStarts[index]] != 0;
+}
+
+void TextBuffer::replaceLines(int firstLine, int count, const QStringList& lines)
+{
+    mRevision = nextRevision();
+    if (mSegments.empty())
+    {
+        for (const QString& line : lines)
+        {
+            appendLine(line);
+        }
+        return;
+    }
+
+    // Segments [first, last] hold the replaced lines, or the place
+    // of the inserted ones. They are built again in a buffer of their
+    // own, their other lines are copied as they are.
+    const int first = segmentOf(std::min(firstLine, mLineCount - 1));
+    const int last = count > 0 ? segmentOf(firstLine + count - 1) : first;
+    const int begin = mSegmentStarts[first];
+    const int end = last + 1 < static_cast<int>(mSegments.size())
+        ? mSegmentStarts[last + 1]
+        : mLineCount;
+
+    TextBuffer rebuilt;
+    Reader reader(*this);
+    for (int lineNum = begin; lineNum < firstLine; ++lineNum)
+    {
+        rebuilt.appendFoldedLine(reader.foldedLine(lineNum), reader.isFoldedLineAscii(lineNum));
+    }
+    for (const QString& line : lines)
+    {
+        rebuilt.appendLine(line);
+    }
+    for (int lineNum = firstLine + count; lineNum < end; ++lineNum)
+    {
+        rebuilt.appendFoldedLine(reader.foldedLine(lineNum), reader.isFoldedLineAscii(lineNum));
+    }
+
+    for (int i = first; i <= last; ++i)
+    {
+        mLength -= mSegments[i]->foldedText.size();
+    }
+    mSegments.erase(mSegments.begin() + first, mSegments.begin() + last + 1);
+    mSegments.insert(mSegments.begin() + first, rebuilt.mSegments.begin(), rebuilt.mSegments.end());
+    mLength += rebuilt.mLength;
+    mLineCount += static_cast<int>(lines.size()) - count;
+
+    mSegmentStarts.resize(mSegments.size());
+    for (size_t i = first; i < mSegments.size(); ++i)
+    {
+        mSegmentStarts[i] = i > 0
+            ? mSegmentStarts[i - 1] + static_cast<int>(mSegments[i - 1]->lineEnds.size())
+            : 0;
+    }
+}
+
+TextBuffer::Segment& TextBuffer::lastSegment()
+{
+    // A single owner is this buffer, nobody else can start sharing
+    // the segment meanwhile. Copies of the buffer keep the old segment.
+    std::shared_ptr<Segment>& segment = mSegments.back();
+    if (segment.use_count() > 1)
+    {
+        segment = std::make_shared<Segment>(*segment);
+    }
+    return *segment;
+}
+
+TextBuffer::Segment& TextBuffer::segmentForAppend()
+{
+    if (mSegments.empty() || mSegments.back()->foldedText.size() >= kSegmentLength)
+    {
+        auto segment = std::make_shared<Segment>();
+        segment->foldedText.reserve(kSegmentLength);
+        mSegments.push_back(std::move(segment));
+        mSegmentStarts.push_back(mLineCount);
+    }
+    return lastSegment();
+}
+
+void TextBuffer::appendFoldedLine(QStringView foldedLine, bool isAscii)
+{
+    Segment& segment = segmentForAppend();
+    segment.foldedText.append(foldedLine);
+    segment.lineEnds.push_back(segment.foldedText.size());
+    segment.asciiLines.push_back(isAscii ? 1 : 0);
+
+    ++mLineCount;
+    mLength += foldedLine.size();
+}
+
+int TextBuffer::segmentOf(int lineNum) const
+{
+    auto it = std::upper_bound(mSegmentStarts.begin(), mSegmentStarts.end(), lineNum);
+    return static_cast<int>(it - mSegmentStarts.begin()) - 1;
+}
+
+QStringView TextBuffer::Segment::line(int n) const
+{
+    const qsizetype start = n > 0 ? lineEnds[n - 1] : 0;
+    return QStringView(foldedText).mid(start, lineEnds[n] - start);
+}
+
+TextBuffer::Reader::Reader(const TextBuffer& text)
+    : mText(text)
+    , mSegmentIndex(-1)
+    , mSegment(nullptr)
+    , mBegin(0)
+    , mEnd(0)
+{
+}
+
+QStringView TextBuffer::Reader::foldedLine(int lineNum)
+{
+    seek(lineNum);
+    return mSegment->line(lineNum - mBegin);
+}
+
+bool TextBuffer::Reader::isFoldedLineAscii(int lineNum)
+{
+    seek(lineNum);
+    return mSegment->asciiLines[lineNum - mBegin] != 0;
+}
+
+void TextBuffer::Reader::seek(int lineNum)
+{
+    if (lineNum >= mBegin && lineNum < mEnd)
+    {
+        return;
+    }
+
+    const int segmentCount = static_cast<int>(mText.mSegments.size());
+    const bool isNext = lineNum >= mEnd
+        && mSegmentIndex + 2 <= segmentCount
+        && (mSegmentIndex + 2 == segmentCount
+            || lineNum < mText.mSegmentStarts[mSegmentIndex + 2]);
+
+    mSegmentIndex = isNext ? mSegmentIndex + 1 : mText.segmentOf(lineNum);
+    mSegment = mText.mSegments[mSegmentIndex].get();
+    mBegin = mText.mSegmentStarts[mSegmentIndex];
+    mEnd = mSegmentIndex + 1 < segmentCount
+        ? mText.mSegmentStarts[mSegmentIndex + 1]
+        : mText.mLineCount;
+}
+
+QString TextBuffer::foldCase(QStringView text)
+{
+    QString folded;
+    appendFolded(folded, text);
+    return folded;
+}
+
+void TextBuffer::appendFolded(QString& folded, QStringView text)
+{
+    const qsizetype start = folded.size();
+    folded.resize(start + text.size());
+
+    char16_t* dst = reinterpret_cast<char16_t*>(folded.data()) + start;
+    const char16_t* src = text.utf16();
+
+    for (qsizetype i = 0; i < text.size(); ++i)
+    {
+        const char16_t c = src[i];
+        if (c < 0x80)
+        {
+            dst[i] = (c >= u'A' && c <= u'Z') ? char16_t(c | 0x20) : c;
+        }
+        else if (QChar::isHighSurrogate(c)
+                 && i + 1 < text.size()
+                 && QChar::isLowSurrogate(src[i + 1]))
+        {
+            const char32_t foldedChar =
+                QChar::toCaseFolded(QChar::surrogateToUcs4(c, src[i + 1]));
+
+            // Folding a character must not change the line length
+            if (QChar::requiresSurrogates(foldedChar))
+            {
+                dst[i] = QChar::highSurrogate(foldedChar);
+                dst[i + 1] = QChar::lowSurrogate(foldedChar);
+            }
+            else
+            {
+                dst[i] = c;
+                dst[i + 1] = src[i + 1];
+            }
+            ++i;
+        }
+        else
+        {
+            const char32_t foldedChar = QChar::toCaseFolded(char32_t(c));
+            dst[i] = QChar::requiresSurrogates(foldedChar) ? c : char16_t(foldedChar);
+        }
+    }
+}
@@ -0,0 +1,122 @@
+#ifndef TEXT_BUFFER_H
+#define TEXT_BUFFER_H
+
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <memory>
+#include <vector>
+
+// Case folded copy of all lines of a document, so matchers work on
+// QStringView slices without copying anything.
+//
+// Only the folded text is kept: the original lines are already in the
+// editor document, or in the decoded input of the filter command, and
+// are read from there for display.
+//
+// Lines are stored in segments of about kSegmentLength characters.
+// Copies of a buffer share their segments, appending to a copy only
+// copies its last segment, and replacing lines only builds again the
+// segments holding them. So a buffer can follow an edited document,
+// and a snapshot of it is taken in time proportional to the segment
+// count, not to the text.
+//
+// Folding is done per character, the same way Qt::CaseInsensitive
+// compares characters, and never changes the length of a line.
+// So a case-sensitive search in the folded copy finds exactly what
+// a case-insensitive search in the original text would.
+class TextBuffer
+{
+private:
+
+    struct Segment;
+
+public:
+
+    TextBuffer();
+
+    void appendLine(QStringView line);
+
+    // Continue the last line, there must be one
+    void appendToLastLine(QStringView text);
+
+    // Replace count lines from firstLine with lines
+    void replaceLines(int firstLine, int count, const QStringList& lines);
+
+    int lineCount() const { return mLineCount; }
+    qsizetype length() const { return mLength; }
+
+    // Looks up the segment of the line, use Reader to read many lines
+    QStringView foldedLine(int lineNum) const;
+
+    // True if the folded line is 7-bit ASCII only
+    bool isFoldedLineAscii(int lineNum) const;
+
+    // Appending keeps the revision, any other change makes a new one.
+    // Buffers of the same revision differ only in appended text, so
+    // filter results of one are valid for the other up to its last line.
+    quint64 revision() const { return mRevision; }
+
+    // Fold text the same way lines are folded
+    static QString foldCase(QStringView text);
+
+    // Reads lines of a buffer, finding the segment of a line only when
+    // it is not the segment of the previous one. Fastest when lines are
+    // read in ascending order, as filter passes and indexing do.
+    class Reader
+    {
+    public:
+
+        explicit Reader(const TextBuffer& text);
+
+        QStringView foldedLine(int lineNum);
+        bool isFoldedLineAscii(int lineNum);
+
+    private:
+
+        void seek(int lineNum);
+
+        const TextBuffer& mText;
+        int mSegmentIndex;
+        const Segment* mSegment;
+
+        // Lines of mSegment are [mBegin, mEnd)
+        int mBegin;
+        int mEnd;
+    };
+
+private:
+
+    // Lines of a segment are one after another in foldedText,
+    // line N ends at lineEnds[N]
+    struct Segment
+    {
+        QStringView line(int n) const;
+
+        QString foldedText;
+        std::vector<qsizetype> lineEnds;
+        std::vector<quint8> asciiLines;
+    };
+
+    // Last segment, copied first if other buffers share it.
+    // A new one is started if the last one is full.
+    Segment& lastSegment();
+    Segment& segmentForAppend();
+
+    void appendFoldedLine(QStringView foldedLine, bool isAscii);
+
+    int segmentOf(int lineNum) const;
+
+    static void appendFolded(QString& folded, QStringView text);
+
+    std::vector<std::shared_ptr<Segment>> mSegments;
+
+    // Number of the first line of every segment
+    std::vector<int> mSegmentStarts;
+
+    int mLineCount;
+    qsizetype mLength;
+    quint64 mRevision;
+};
+
+#endif // TEXT_BUFFER_H
@@ -0,0 +1,504 @@
+#include "TextCodec.h"
+
+#include <QtAlgorithms>
+#include <QtEndian>
+#include <algorithm>
+#include <iterator>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TEXT_CODEC_SSE2
+#include <immintrin.h>
+#endif
+
+namespace
+{
+
+constexpr char16_t kReplacementCharacter = 0xfffd;
+
+inline bool isContinuation(uchar c)
+{
+    return (c & 0xc0) == 0x80;
+}
+
+// Length of the valid UTF-8 sequence at in, 0 if it is invalid.
+// Overlong forms, surrogates and code points above U+10FFFF are invalid.
+// If truncated is set, a valid beginning of a sequence cut by the
+// end of input gets its full length.
+int sequenceLength(const uchar* in, qsizetype available, char32_t& codePoint, bool* truncated = nullptr)
+{
+    const uchar c = in[0];
+
+    int length = 0;
+    char32_t min = 0;
+    if (c >= 0xc2 && c <= 0xdf)
+    {
+        length = 2;
+        codePoint = c & 0x1f;
+        min = 0x80;
+    }
+    else if (c >= 0xe0 && c <= 0xef)
+    {
+        length = 3;
+        codePoint = c & 0x0f;
+        min = 0x800;
+    }
+    else if (c >= 0xf0 && c <= 0xf4)
+    {
+        length = 4;
+        codePoint = c & 0x07;
+        min = 0x10000;
+    }
+    else
+    {
+        return 0;
+    }
+
+    for (int i = 1; i < length; ++i)
+    {
+        if (i >= available)
+        {
+            if (truncated != nullptr)
+            {
+                *truncated = true;
+                return length;
+            }
+            return 0;
+        }
+        if (!isContinuation(in[i]))
+        {
+            return 0;
+        }
+        codePoint = (codePoint << 6) | (in[i] & 0x3f);
+    }
+
+    if (codePoint < min
+        || codePoint > 0x10ffff
+        || (codePoint >= 0xd800 && codePoint <= 0xdfff))
+    {
+        return 0;
+    }
+    return length;
+}
+
+// Widen bytes to out until the first \r, or until the first byte
+// above 0x7f if asciiOnly is set. Returns the number of bytes widened.
+qsizetype widenScalar(const uchar* in, qsizetype length, char16_t* out, bool asciiOnly)
+{
+    qsizetype i = 0;
+    for (; i < length; ++i)
+    {
+        const uchar c = in[i];
+        if (c == '\r' || (asciiOnly && c >= 0x80))
+        {
+            break;
+        }
+        out[i] = c;
+    }
+    return i;
+}
+
+#ifdef TEXT_CODEC_SSE2
+
+qsizetype widen(const uchar* in, qsizetype length, char16_t* out, bool asciiOnly)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i carriageReturn = _mm_set1_epi8('\r');
+
+    qsizetype i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+
+        // High bit of a byte is its sign, movemask collects them
+        quint32 stop = quint32(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, carriageReturn)));
+        if (asciiOnly)
+        {
+            stop |= quint32(_mm_movemask_epi8(bytes));
+        }
+        if (stop != 0)
+        {
+            const qsizetype count = qCountTrailingZeroBits(stop);
+            for (qsizetype j = 0; j < count; ++j)
+            {
+                out[i + j] = in[i + j];
+            }
+            return i + count;
+        }
+
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(out + i),
+            _mm_unpacklo_epi8(bytes, zero));
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(out + i + 8),
+            _mm_unpackhi_epi8(bytes, zero));
+    }
+
+    return i + widenScalar(in + i, length - i, out + i, asciiOnly);
+}
+
+// Narrow text to out while it is ASCII.
+// Returns the number of characters narrowed.
+qsizetype narrowAscii(const char16_t* text, qsizetype length, char* out)
+{
+    const __m128i nonAscii = _mm_set1_epi16(short(0xff80));
+
+    qsizetype i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+        const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+        const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i + 8));
+        const __m128i bits = _mm_and_si128(_mm_or_si128(low, high), nonAscii);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(bits, _mm_setzero_si128())) != 0xffff)
+        {
+            break;
+        }
+
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(out + i),
+            _mm_packus_epi16(low, high));
+    }
+
+    for (; i < length && text[i] < 0x80; ++i)
+    {
+        out[i] = char(text[i]);
+    }
+    return i;
+}
+
+#else
+
+qsizetype widen(const uchar* in, qsizetype length, char16_t* out, bool asciiOnly)
+{
+    return widenScalar(in, length, out, asciiOnly);
+}
+
+qsizetype narrowAscii(const char16_t* text, qsizetype length, char* out)
+{
+    qsizetype i = 0;
+    for (; i < length && text[i] < 0x80; ++i)
+    {
+        out[i] = char(text[i]);
+    }
+    return i;
+}
+
+#endif
+
+// \r of \r\n is dropped, a lone \r stays.
+// Returns the number of bytes consumed and sets written.
+inline qsizetype carriageReturn(const uchar* in, qsizetype available, char16_t* out, qsizetype& written)
+{
+    if (available > 1 && in[1] == '\n')
+    {
+        written = 0;
+        return 1;
+    }
+    out[0] = u'\r';
+    written = 1;
+    return 1;
+}
+
+qsizetype decodeUtf8(const uchar* in, qsizetype length, char16_t* out)
+{
+    char16_t* const begin = out;
+
+    qsizetype i = 0;
+    while (i < length)
+    {
+        const qsizetype ascii = widen(in + i, length - i, out, true);
+        i += ascii;
+        out += ascii;
+        if (i == length)
+        {
+            break;
+        }
+
+        if (in[i] == '\r')
+        {
+            qsizetype written = 0;
+            i += carriageReturn(in + i, length - i, out, written);
+            out += written;
+            continue;
+        }
+
+        char32_t codePoint = 0;
+        const int sequence = sequenceLength(in + i, length - i, codePoint);
+        if (sequence == 0)
+        {
+            *out++ = kReplacementCharacter;
+            ++i;
+        }
+        else if (codePoint < 0x10000)
+        {
+            *out++ = char16_t(codePoint);
+            i += sequence;
+        }
+        else
+        {
+            *out++ = char16_t(0xd800 + ((codePoint - 0x10000) >> 10));
+            *out++ = char16_t(0xdc00 + ((codePoint - 0x10000) & 0x3ff));
+            i += sequence;
+        }
+    }
+
+    return out - begin;
+}
+
+qsizetype decodeLatin1(const uchar* in, qsizetype length, char16_t* out)
+{
+    char16_t* const begin = out;
+
+    qsizetype i = 0;
+    while (i < length)
+    {
+        const qsizetype widened = widen(in + i, length - i, out, false);
+        i += widened;
+        out += widened;
+        if (i < length)
+        {
+            qsizetype written = 0;
+            i += carriageReturn(in + i, length - i, out, written);
+            out += written;
+        }
+    }
+
+    return out - begin;
+}
+
+qsizetype decodeUtf16(const uchar* in, qsizetype length, char16_t* out, bool isBigEndian)
+{
+    char16_t* const begin = out;
+
+    // Odd last byte is not a character
+    const qsizetype count = length / 2;
+    for (qsizetype i = 0; i < count; ++i)
+    {
+        const char16_t c = isBigEndian
+            ? qFromBigEndian<quint16>(in + 2 * i)
+            : qFromLittleEndian<quint16>(in + 2 * i);
+
+        if (c == u'\r' && i + 1 < count)
+        {
+            const char16_t next = isBigEndian
+                ? qFromBigEndian<quint16>(in + 2 * i + 2)
+                : qFromLittleEndian<quint16>(in + 2 * i + 2);
+            if (next == u'\n')
+            {
+                continue;
+            }
+        }
+        *out++ = c;
+    }
+
+    return out - begin;
+}
+
+}
+
+TextCodec::Encoding TextCodec::detect(QByteArrayView head, int& bomLength)
+{
+    const auto* bytes = reinterpret_cast<const uchar*>(head.data());
+
+    if (head.size() >= 3 && bytes[0] == 0xef && bytes[1] == 0xbb && bytes[2] == 0xbf)
+    {
+        bomLength = 3;
+        return Encoding::Utf8;
+    }
+    if (head.size() >= 2 && bytes[0] == 0xff && bytes[1] == 0xfe)
+    {
+        bomLength = 2;
+        return Encoding::Utf16LE;
+    }
+    if (head.size() >= 2 && bytes[0] == 0xfe && bytes[1] == 0xff)
+    {
+        bomLength = 2;
+        return Encoding::Utf16BE;
+    }
+
+    bomLength = 0;
+    return isValidUtf8(head) ? Encoding::Utf8 : Encoding::Latin1;
+}
+
+bool TextCodec::isValidUtf8(QByteArrayView bytes)
+{
+    const auto* in = reinterpret_cast<const uchar*>(bytes.data());
+    const qsizetype length = bytes.size();
+
+    // Widened characters are thrown away, only the position matters
+    char16_t scratch[256];
+
+    qsizetype i = 0;
+    while (i < length)
+    {
+        const qsizetype chunk = std::min<qsizetype>(length - i, std::size(scratch));
+        const qsizetype ascii = widen(in + i, chunk, scratch, true);
+        i += ascii;
+        if (ascii == chunk)
+        {
+            continue;
+        }
+
+        // Stopped at \r
+        if (in[i] < 0x80)
+        {
+            ++i;
+            continue;
+        }
+
+        char32_t codePoint = 0;
+        bool truncated = false;
+        const int sequence = sequenceLength(in + i, length - i, codePoint, &truncated);
+        if (sequence == 0)
+        {
+            return false;
+        }
+        if (truncated)
+        {
+            break;
+        }
+        i += sequence;
+    }
+    return true;
+}
+
+qsizetype TextCodec::decode(QByteArrayView bytes, Encoding encoding, char16_t* out)
+{
+    const auto* in = reinterpret_cast<const uchar*>(bytes.data());
+
+    switch (encoding)
+    {
+    case Encoding::Utf16LE:
+        return decodeUtf16(in, bytes.size(), out, false);
+    case Encoding::Utf16BE:
+        return decodeUtf16(in, bytes.size(), out, true);
+    case Encoding::Latin1:
+        return decodeLatin1(in, bytes.size(), out);
+    case Encoding::Utf8:
+        break;
+    }
+    return decodeUtf8(in, bytes.size(), out);
+}
+
+QString TextCodec::decode(QByteArrayView bytes, Encoding encoding)
+{
+    QString text(bytes.size(), Qt::Uninitialized);
+    text.truncate(decode(bytes, encoding, reinterpret_cast<char16_t*>(text.data())));
+    return text;
+}
+
+qsizetype TextCodec::completeLength(QByteArrayView bytes, Encoding encoding)
+{
+    const auto* in = reinterpret_cast<const uchar*>(bytes.data());
+    const qsizetype length = bytes.size();
+
+    switch (encoding)
+    {
+    case Encoding::Utf16LE:
+    case Encoding::Utf16BE:
+    {
+        const qsizetype even = length & ~qsizetype(1);
+        if (even == 0)
+        {
+            return 0;
+        }
+        const char16_t last = encoding == Encoding::Utf16BE
+            ? qFromBigEndian<quint16>(in + even - 2)
+            : qFromLittleEndian<quint16>(in + even - 2);
+        return QChar::isHighSurrogate(last) ? even - 2 : even;
+    }
+    case Encoding::Latin1:
+        return length;
+    case Encoding::Utf8:
+        break;
+    }
+
+    // First byte of the last sequence, which is 4 bytes at most
+    for (qsizetype i = length - 1; i >= 0 && i >= length - 4; --i)
+    {
+        if (isContinuation(in[i]))
+        {
+            continue;
+        }
+
+        char32_t codePoint = 0;
+        bool truncated = false;
+        const int sequence = sequenceLength(in + i, length - i, codePoint, &truncated);
+        return sequence != 0 && truncated ? i : length;
+    }
+    return length;
+}
+
+qsizetype TextCodec::lastLineEnd(QByteArrayView bytes, Encoding encoding)
+{
+    if (encoding == Encoding::Utf16LE || encoding == Encoding::Utf16BE)
+    {
+        const auto* in = reinterpret_cast<const uchar*>(bytes.data());
+        for (qsizetype i = (bytes.size() & ~qsizetype(1)) - 2; i >= 0; i -= 2)
+        {
+            const char16_t c = encoding == Encoding::Utf16BE
+                ? qFromBigEndian<quint16>(in + i)
+                : qFromLittleEndian<quint16>(in + i);
+            if (c == u'\n')
+            {
+                return i + 2;
+            }
+        }
+        return 0;
+    }
+
+    return bytes.lastIndexOf('\n') + 1;
+}
+
+QByteArray TextCodec::encodeUtf8(QStringView text)
+{
+    const char16_t* in = text.utf16();
+    const qsizetype length = text.size();
+
+    // Three bytes per character at most, a surrogate pair takes four
+    QByteArray bytes(length * 3, Qt::Uninitialized);
+    char* out = bytes.data();
+
+    qsizetype i = 0;
+    while (i < length)
+    {
+        const qsizetype ascii = narrowAscii(in + i, length - i, out);
+        i += ascii;
+        out += ascii;
+        if (i == length)
+        {
+            break;
+        }
+
+        char32_t c = in[i++];
+        if (QChar::isHighSurrogate(c) && i < length && QChar::isLowSurrogate(in[i]))
+        {
+            c = QChar::surrogateToUcs4(char16_t(c), in[i++]);
+        }
+        else if (QChar::isSurrogate(c))
+        {
+            c = kReplacementCharacter;
+        }
+
+        if (c < 0x800)
+        {
+            *out++ = char(0xc0 | (c >> 6));
+            *out++ = char(0x80 | (c & 0x3f));
+        }
+        else if (c < 0x10000)
+        {
+            *out++ = char(0xe0 | (c >> 12));
+            *out++ = char(0x80 | ((c >> 6) & 0x3f));
+            *out++ = char(0x80 | (c & 0x3f));
+        }
+        else
+        {
+            *out++ = char(0xf0 | (c >> 18));
+            *out++ = char(0x80 | ((c >> 12) & 0x3f));
+            *out++ = char(0x80 | ((c >> 6) & 0x3f));
+            *out++ = char(0x80 | (c & 0x3f));
+        }
+    }
+
+    bytes.truncate(out - bytes.constData());
+    return bytes;
+}
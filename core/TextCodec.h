@@ -0,0 +1,54 @@
+#ifndef TEXT_CODEC_H
+#define TEXT_CODEC_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+#include <QStringView>
+
+// Conversion between bytes of a file and UTF-16 text.
+// Decoding turns \r\n into \n in the same pass. Runs of plain ASCII,
+// which is most of a typical log, are converted 16 bytes at a time
+// with SSE2 (scalar on other CPUs), other characters one by one.
+namespace TextCodec
+{
+
+enum class Encoding
+{
+    Utf8,
+    Utf16LE,
+    Utf16BE,
+    Latin1
+};
+
+// Encoding given by the byte order mark at the beginning of the file.
+// Without one, it is UTF-8 if head is valid UTF-8, Latin-1 otherwise.
+// bomLength gets the size of the byte order mark, 0 if there is none.
+Encoding detect(QByteArrayView head, int& bomLength);
+
+// True if bytes are valid UTF-8.
+// A sequence cut by the end of bytes is accepted.
+bool isValidUtf8(QByteArrayView bytes);
+
+// Decode bytes to out, which must have room for bytes.size() characters.
+// Invalid UTF-8 sequences become U+FFFD, like in QString::fromUtf8.
+// Returns the number of characters written.
+qsizetype decode(QByteArrayView bytes, Encoding encoding, char16_t* out);
+
+QString decode(QByteArrayView bytes, Encoding encoding);
+
+// Length of bytes without a character cut by their end, i.e. the
+// beginning of a UTF-8 sequence, an odd byte or a high surrogate
+// of UTF-16. The rest is decoded with the bytes which follow it.
+qsizetype completeLength(QByteArrayView bytes, Encoding encoding);
+
+// Length of bytes up to and including their last \n,
+// 0 if there is none. Text is cut there into whole lines.
+qsizetype lastLineEnd(QByteArrayView bytes, Encoding encoding);
+
+// Unpaired surrogates become U+FFFD
+QByteArray encodeUtf8(QStringView text);
+
+};
+
+#endif // TEXT_CODEC_H
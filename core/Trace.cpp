@@ -0,0 +1,161 @@
+#include "Trace.h"
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <mutex>
+
+namespace
+{
+
+// About 10 MB of events, a few minutes of typing
+constexpr size_t kMaxEvents = 100000;
+
+std::atomic<bool> enabled(false);
+
+std::mutex eventsMutex;
+std::deque<Trace::Event> events;
+
+const QElapsedTimer& traceClock()
+{
+    static const QElapsedTimer timer = []()
+    {
+        QElapsedTimer timer;
+        timer.start();
+        return timer;
+    }();
+    return timer;
+}
+
+int currentThreadId()
+{
+    static std::atomic<int> nextId(1);
+    thread_local const int id = nextId++;
+    return id;
+}
+
+void record(Trace::Event&& event)
+{
+    std::lock_guard<std::mutex> lock(eventsMutex);
+    if (events.size() >= kMaxEvents)
+    {
+        events.pop_front();
+    }
+    events.push_back(std::move(event));
+}
+
+}
+
+void Trace::setEnabled(bool isEnabled)
+{
+    enabled = isEnabled;
+    if (!isEnabled)
+    {
+        std::lock_guard<std::mutex> lock(eventsMutex);
+        events.clear();
+    }
+}
+
+bool Trace::isEnabled()
+{
+    return enabled.load(std::memory_order_relaxed);
+}
+
+qint64 Trace::now()
+{
+    return traceClock().nsecsElapsed() / 1000;
+}
+
+std::vector<Trace::Event> Trace::eventsSince(qint64 time)
+{
+    std::vector<Event> result;
+    std::lock_guard<std::mutex> lock(eventsMutex);
+    for (const Event& event : events)
+    {
+        if (event.start >= time)
+        {
+            result.push_back(event);
+        }
+    }
+    std::sort(
+        result.begin(),
+        result.end(),
+        [](const Event& a, const Event& b) { return a.start < b.start; });
+    return result;
+}
+
+bool Trace::writeChromeTrace(const QString& filename)
+{
+    QJsonArray traceEvents;
+    {
+        std::lock_guard<std::mutex> lock(eventsMutex);
+        for (const Event& event : events)
+        {
+            QJsonObject counters;
+            for (const auto& counter : event.counters)
+            {
+                counters[QLatin1String(counter.first)] = double(counter.second);
+            }
+
+            // Complete event, "X" in the trace event format
+            QJsonObject object;
+            object["name"] = QLatin1String(event.name);
+            object["cat"] = QLatin1String("textfilter");
+            object["ph"] = QLatin1String("X");
+            object["ts"] = double(event.start);
+            object["dur"] = double(event.duration);
+            object["pid"] = 1;
+            object["tid"] = event.threadId;
+            if (!counters.isEmpty())
+            {
+                object["args"] = counters;
+            }
+            traceEvents.append(object);
+        }
+    }
+
+    QJsonObject trace;
+    trace["traceEvents"] = traceEvents;
+    trace["displayTimeUnit"] = QLatin1String("ms");
+
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        return false;
+    }
+    file.write(QJsonDocument(trace).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
+
+Trace::Scope::Scope(const char* name)
+    : mName(name)
+    , mStart(0)
+    , mIsEnabled(isEnabled())
+{
+    if (mIsEnabled)
+    {
+        mStart = now();
+    }
+}
+
+Trace::Scope::~Scope()
+{
+    if (mIsEnabled)
+    {
+        record({mName, mStart, now() - mStart, currentThreadId(), std::move(mCounters)});
+    }
+}
+
+void Trace::Scope::setCounter(const char* name, qint64 value)
+{
+    if (mIsEnabled)
+    {
+        mCounters.emplace_back(name, value);
+    }
+}
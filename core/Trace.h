@@ -0,0 +1,69 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QString>
+#include <utility>
+#include <vector>
+
+// Timings of the stages of filtering, loading and saving.
+// A Scope measures the block it lives in, on any thread, and records
+// it as an event with counters like lines scanned or bytes allocated.
+// While recording is off, which is the default, a Scope costs one
+// atomic load and records nothing.
+//
+// Recorded events can be written as a Chrome trace,
+// which chrome://tracing and ui.perfetto.dev open.
+namespace Trace
+{
+
+struct Event
+{
+    // Scope names are string literals, they are never copied
+    const char* name;
+
+    // Microseconds on the clock of now()
+    qint64 start;
+    qint64 duration;
+
+    // Small number which is the same for all events of a thread
+    int threadId;
+
+    std::vector<std::pair<const char*, qint64>> counters;
+};
+
+void setEnabled(bool isEnabled);
+bool isEnabled();
+
+// Microseconds since the first use of the clock
+qint64 now();
+
+// Events which started at or after time, oldest first
+std::vector<Event> eventsSince(qint64 time);
+
+// Write all events kept so far. The oldest ones are dropped
+// when too many are kept, so the file shows the recent past.
+bool writeChromeTrace(const QString& filename);
+
+class Scope
+{
+public:
+
+    explicit Scope(const char* name);
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    void setCounter(const char* name, qint64 value);
+
+private:
+
+    const char* mName;
+    qint64 mStart;
+    bool mIsEnabled;
+    std::vector<std::pair<const char*, qint64>> mCounters;
+};
+
+};
+
+#endif // TRACE_H
@@ -0,0 +1,326 @@
+#include "TrigramIndex.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace
+{
+
+// Filter items shorter than this have no trigram
+constexpr int kTrigramLength = 3;
+
+inline quint64 trigramAt(const char16_t* text)
+{
+    return (quint64(text[0]) << 32) | (quint64(text[1]) << 16) | quint64(text[2]);
+}
+
+}
+
+TrigramIndex::TrigramIndex(const TextBuffer& text)
+{
+    mLineHashes.reserve(text.lineCount());
+    hashLines(text, 0, mLineHashes);
+    addLines(text, 0, text.lineCount());
+}
+
+TrigramIndex::TrigramIndex(
+    const TrigramIndex& previous,
+    const TextBuffer& text,
+    int firstChangedLine)
+    : mPostings(previous.mPostings)
+    , mLineHashes(previous.mLineHashes)
+{
+    const int oldCount = static_cast<int>(mLineHashes.size());
+    const int newCount = text.lineCount();
+    const int maxCommon = std::min(oldCount, newCount);
+    const int unchanged = std::clamp(firstChangedLine, 0, maxCommon);
+
+    std::vector<size_t> hashes;
+    hashes.reserve(newCount);
+    hashes.assign(mLineHashes.begin(), mLineHashes.begin() + unchanged);
+    hashLines(text, unchanged, hashes);
+
+    // Lines at the beginning and at the end which did not change
+    int prefix = unchanged;
+    while (prefix < maxCommon && hashes[prefix] == mLineHashes[prefix])
+    {
+        ++prefix;
+    }
+
+    int suffix = 0;
+    while (suffix < maxCommon - prefix
+           && hashes[newCount - 1 - suffix] == mLineHashes[oldCount - 1 - suffix])
+    {
+        ++suffix;
+    }
+
+    const int addedCount = newCount - prefix - suffix;
+    if (addedCount > newCount / 2)
+    {
+        // Mostly different text, indexing from scratch is cheaper
+        mPostings.clear();
+        addLines(text, 0, newCount);
+    }
+    else
+    {
+        replaceLines(text, prefix, oldCount - prefix - suffix, addedCount);
+    }
+
+    mLineHashes = std::move(hashes);
+}
+
+template<typename Function>
+void TrigramIndex::forEachTrigram(QStringView foldedLine, Function function)
+{
+    const char16_t* text = foldedLine.utf16();
+    for (qsizetype i = 0; i + kTrigramLength <= foldedLine.size(); ++i)
+    {
+        function(trigramAt(text + i));
+    }
+}
+
+void TrigramIndex::hashLines(
+    const TextBuffer& text,
+    int first,
+    std::vector<size_t>& hashes)
+{
+    TextBuffer::Reader reader(text);
+    for (int line = first; line < text.lineCount(); ++line)
+    {
+        hashes.push_back(qHash(reader.foldedLine(line)));
+    }
+}
+
+void TrigramIndex::append(PostingList& list, int lineNum)
+{
+    quint32 delta = static_cast<quint32>(lineNum - list.lastLine);
+    while (delta >= 0x80)
+    {
+        list.deltas.append(char((delta & 0x7f) | 0x80));
+        delta >>= 7;
+    }
+    list.deltas.append(char(delta));
+
+    list.lastLine = lineNum;
+    ++list.count;
+}
+
+std::vector<int> TrigramIndex::decode(const PostingList& list)
+{
+    std::vector<int> lines;
+    lines.reserve(list.count);
+
+    int line = -1;
+    quint32 delta = 0;
+    int shift = 0;
+    for (char byte : list.deltas)
+    {
+        delta |= quint32(uchar(byte) & 0x7f) << shift;
+        if (uchar(byte) & 0x80)
+        {
+            shift += 7;
+            continue;
+        }
+
+        line += static_cast<int>(delta);
+        lines.push_back(line);
+        delta = 0;
+        shift = 0;
+    }
+    return lines;
+}
+
+void TrigramIndex::intersect(std::vector<int>& lines, const PostingList& list)
+{
+    size_t kept = 0;
+    size_t next = 0;
+
+    int posted = -1;
+    quint32 delta = 0;
+    int shift = 0;
+    for (char byte : list.deltas)
+    {
+        delta |= quint32(uchar(byte) & 0x7f) << shift;
+        if (uchar(byte) & 0x80)
+        {
+            shift += 7;
+            continue;
+        }
+
+        posted += static_cast<int>(delta);
+        delta = 0;
+        shift = 0;
+
+        while (next < lines.size() && lines[next] < posted)
+        {
+            ++next;
+        }
+        if (next == lines.size())
+        {
+            break;
+        }
+        if (lines[next] == posted)
+        {
+            lines[kept++] = posted;
+            ++next;
+        }
+    }
+
+    lines.resize(kept);
+}
+
+void TrigramIndex::addLines(const TextBuffer& text, int first, int count)
+{
+    TextBuffer::Reader reader(text);
+    for (int line = first; line < first + count; ++line)
+    {
+        forEachTrigram(
+            reader.foldedLine(line),
+            [this, line](quint64 trigram)
+            {
+                PostingList& list = mPostings[trigram];
+                if (list.lastLine != line)
+                {
+                    append(list, line);
+                }
+            });
+    }
+}
+
+void TrigramIndex::replaceLines(
+    const TextBuffer& text,
+    int first,
+    int removedCount,
+    int addedCount)
+{
+    const int removedEnd = first + removedCount;
+    const int shift = addedCount - removedCount;
+
+    // Trigrams of the new lines with their ascending line numbers
+    QHash<quint64, std::vector<int>> addedLines;
+    TextBuffer::Reader reader(text);
+    for (int line = first; line < first + addedCount; ++line)
+    {
+        forEachTrigram(
+            reader.foldedLine(line),
+            [&addedLines, line](quint64 trigram)
+            {
+                std::vector<int>& lines = addedLines[trigram];
+                if (lines.empty() || lines.back() != line)
+                {
+                    lines.push_back(line);
+                }
+            });
+    }
+
+    for (auto it = mPostings.begin(); it != mPostings.end(); )
+    {
+        auto added = addedLines.find(it.key());
+        const bool hasAddedLines = added != addedLines.end();
+
+        // Everything is before the changed lines
+        if (!hasAddedLines && it->lastLine < first)
+        {
+            ++it;
+            continue;
+        }
+
+        const std::vector<int> lines = decode(*it);
+        PostingList rebuilt;
+
+        auto line = lines.begin();
+        for (; line != lines.end() && *line < first; ++line)
+        {
+            append(rebuilt, *line);
+        }
+
+        if (hasAddedLines)
+        {
+            for (int addedLine : *added)
+            {
+                append(rebuilt, addedLine);
+            }
+            addedLines.erase(added);
+        }
+
+        for (; line != lines.end(); ++line)
+        {
+            if (*line >= removedEnd)
+            {
+                append(rebuilt, *line + shift);
+            }
+        }
+
+        if (rebuilt.count == 0)
+        {
+            it = mPostings.erase(it);
+        }
+        else
+        {
+            *it = std::move(rebuilt);
+            ++it;
+        }
+    }
+
+    // Trigrams which were not in the text before
+    for (auto it = addedLines.cbegin(); it != addedLines.cend(); ++it)
+    {
+        PostingList& list = mPostings[it.key()];
+        for (int line : it.value())
+        {
+            append(list, line);
+        }
+    }
+}
+
+bool TrigramIndex::findCandidates(
+    const FilterQuery& query,
+    std::vector<int>& lines) const
+{
+    std::vector<const PostingList*> lists;
+    for (int item = 0; item < query.itemCount(); ++item)
+    {
+        const QStringView foldedItem = query.foldedItem(item);
+        if (foldedItem.size() < kTrigramLength)
+        {
+            continue;
+        }
+
+        for (qsizetype i = 0; i + kTrigramLength <= foldedItem.size(); ++i)
+        {
+            auto it = mPostings.constFind(trigramAt(foldedItem.utf16() + i));
+            if (it == mPostings.cend())
+            {
+                // No line contains this item
+                lines.clear();
+                return true;
+            }
+            lists.push_back(&it.value());
+        }
+    }
+
+    if (lists.empty())
+    {
+        return false;
+    }
+
+    // Start from the shortest list, so the others shrink it fast
+    // Repeated trigrams end up next to each other and are dropped
+    std::sort(
+        lists.begin(),
+        lists.end(),
+        [](const PostingList* a, const PostingList* b)
+        {
+            return a->count != b->count
+                ? a->count < b->count
+                : std::less<const PostingList*>()(a, b);
+        });
+    lists.erase(std::unique(lists.begin(), lists.end()), lists.end());
+
+    lines = decode(*lists.front());
+    for (size_t i = 1; i < lists.size() && !lines.empty(); ++i)
+    {
+        intersect(lines, *lists[i]);
+    }
+    return true;
+}
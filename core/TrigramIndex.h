@@ -0,0 +1,77 @@
+#ifndef TRIGRAM_INDEX_H
+#define TRIGRAM_INDEX_H
+
+#include "FilterQuery.h"
+#include "TextBuffer.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <vector>
+
+// For every three folded characters which occur in the text,
+// the list of lines containing them. A line can only match a filter
+// item if it contains all trigrams of the item, so intersecting their
+// lists gives a few candidate lines instead of scanning all of them.
+//
+// Line lists are stored as varint encoded deltas, which keeps
+// the index at a fraction of the text size.
+class TrigramIndex
+{
+public:
+
+    // Index all lines of text
+    explicit TrigramIndex(const TextBuffer& text);
+
+    // Index text, starting from the index of its earlier version.
+    // Only lines which changed since then are indexed again.
+    // Lines before firstChangedLine are known to be the same,
+    // e.g. when lines were appended, and are not compared.
+    TrigramIndex(
+        const TrigramIndex& previous,
+        const TextBuffer& text,
+        int firstChangedLine = 0);
+
+    // Lines which may match the query, ascending.
+    // Returns false if no filter item is long enough to use
+    // the index, the caller has to scan all lines then.
+    bool findCandidates(const FilterQuery& query, std::vector<int>& lines) const;
+
+    int lineCount() const { return static_cast<int>(mLineHashes.size()); }
+
+private:
+
+    struct PostingList
+    {
+        QByteArray deltas;
+        int lastLine = -1;
+        int count = 0;
+    };
+
+    template<typename Function>
+    static void forEachTrigram(QStringView foldedLine, Function function);
+
+    // Append hashes of lines from first to the end of text
+    static void hashLines(const TextBuffer& text, int first, std::vector<size_t>& hashes);
+    static void append(PostingList& list, int lineNum);
+    static std::vector<int> decode(const PostingList& list);
+
+    // Keep only those lines which are also in list
+    static void intersect(std::vector<int>& lines, const PostingList& list);
+
+    void addLines(const TextBuffer& text, int first, int count);
+
+    // Replace removedCount lines starting from first
+    // with addedCount lines of text
+    void replaceLines(
+        const TextBuffer& text,
+        int first,
+        int removedCount,
+        int addedCount);
+
+    QHash<quint64, PostingList> mPostings;
+
+    // Hash of every indexed folded line, to find changed lines
+    std::vector<size_t> mLineHashes;
+};
+
+#endif // TRIGRAM_INDEX_H
@@ -0,0 +1,14 @@
+# Include from a project to build against the textfilter-core library
+
+QT += concurrent
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+CORE_LIB_DIR = $$shadowed($$PWD)
+
+LIBS += -L$$CORE_LIB_DIR -ltextfilter-core
+
+# Relink when the library changes
+PRE_TARGETDEPS += \
+    $$CORE_LIB_DIR/$${QMAKE_PREFIX_STATICLIB}textfilter-core.$${QMAKE_EXTENSION_STATICLIB}
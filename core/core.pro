@@ -0,0 +1,41 @@
+# Filter engine of TextFilter: matching, line index, match lists
+# and file loading. Depends on QtCore and QtConcurrent only, so the
+# window, the headless mode and benchmarks can all link it.
+
+QT = core concurrent
+
+TARGET = textfilter-core
+TEMPLATE = lib
+CONFIG += staticlib
+
+# Library goes where core.pri looks for it,
+# without the debug and release subdirectories
+DESTDIR = $$OUT_PWD
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+SOURCES += \
+    Document.cpp \
+    FileFollower.cpp \
+    FileManager.cpp \
+    FilterQuery.cpp \
+    MappedFile.cpp \
+    MatchList.cpp \
+    StringSearch.cpp \
+    TextBuffer.cpp \
+    TextCodec.cpp \
+    Trace.cpp \
+    TrigramIndex.cpp
+
+HEADERS += \
+    Document.h \
+    FileFollower.h \
+    FileManager.h \
+    FilterQuery.h \
+    MappedFile.h \
+    MatchList.h \
+    StringSearch.h \
+    TextBuffer.h \
+    TextCodec.h \
+    Trace.h \
+    TrigramIndex.h
@@ -0,0 +1,359 @@
+#include "Document.h"
+#include "FilterQuery.h"
+#include "MatchList.h"
+#include "TextBuffer.h"
+
+#include <QRandomGenerator>
+#include <QtTest>
+
+#include <memory>
+#include <vector>
+
+namespace
+{
+
+QStringList randomLines(QRandomGenerator& random, int count)
+{
+    const QStringList words = {
+        "error", "Error", "warning", "disk", "network", "timeout",
+        "user", "login", "failed", "ok", QString::fromUtf8("äpfel"), QString::fromUtf8("ÄPFEL")
+    };
+
+    QStringList lines;
+    for (int i = 0; i < count; ++i)
+    {
+        QStringList line;
+        const int wordCount = random.bounded(7);
+        for (int n = 0; n < wordCount; ++n)
+        {
+            line += words.at(random.bounded(words.size()));
+        }
+        line += QString::number(random.bounded(1000));
+        lines += line.join(u' ');
+    }
+    return lines;
+}
+
+std::shared_ptr<TextBuffer> textBuffer(const QStringList& lines)
+{
+    auto text = std::make_shared<TextBuffer>();
+    for (const QString& line : lines)
+    {
+        text->appendLine(line);
+    }
+    return text;
+}
+
+// Match the way the first version of the filter found it: items are
+// searched in the original line in order, each after the previous one
+bool referenceMatch(const QString& line, const QString& filter, std::vector<HighlightArea>& areas)
+{
+    areas.clear();
+    qsizetype fromIndex = 0;
+    for (const QString& item : filter.split(" ", Qt::SkipEmptyParts))
+    {
+        const qsizetype indexOf = line.indexOf(item, fromIndex, Qt::CaseInsensitive);
+        if (indexOf == -1)
+        {
+            return false;
+        }
+        fromIndex = indexOf + item.length();
+        areas.emplace_back(static_cast<int>(indexOf), static_cast<int>(fromIndex));
+    }
+    return true;
+}
+
+// Matches have to be the lines and areas a full scan of all lines
+// with the reference match finds
+void compareWithFullScan(const QStringList& lines, const QString& filter, const MatchList& matches)
+{
+    std::vector<HighlightArea> areas;
+    int n = 0;
+    for (int lineNum = 0; lineNum < lines.size(); ++lineNum)
+    {
+        if (!referenceMatch(lines[lineNum], filter, areas))
+        {
+            continue;
+        }
+
+        QVERIFY2(n < matches.size(), qPrintable(filter));
+        QCOMPARE(matches.lineAt(n), lineNum);
+        QCOMPARE(int(matches.areaEnd(n) - matches.areaBegin(n)), int(areas.size()));
+        for (size_t i = 0; i < areas.size(); ++i)
+        {
+            QCOMPARE(matches.areaBegin(n)[i].begin, areas[i].begin);
+            QCOMPARE(matches.areaBegin(n)[i].end, areas[i].end);
+        }
+        ++n;
+    }
+    QCOMPARE(matches.size(), n);
+}
+
+}
+
+class TestDocument : public QObject
+{
+    Q_OBJECT
+
+private slots:
+
+    void inOrderItemsMatchFullScan();
+    void narrowingMatchesFullScan();
+    void indexedFilterMatchesFullScan();
+    void backspaceReusesHistory();
+    void resultCacheDropsLeastRecentlyUsed();
+    void appendedTextMatchesFullScan();
+};
+
+void TestDocument::inOrderItemsMatchFullScan()
+{
+    QRandomGenerator random(5);
+    const QStringList lines = randomLines(random, 5000);
+    const std::shared_ptr<TextBuffer> text = textBuffer(lines);
+
+    // Items in and out of order, repeated ones, ones found inside
+    // the previous item's word, and case which differs from the text
+    const QStringList filters = {
+        QStringLiteral("error"),
+        QStringLiteral("ERROR disk"),
+        QStringLiteral("disk error"),
+        QStringLiteral("o o o"),
+        QStringLiteral("er er"),
+        QStringLiteral("net work"),
+        QStringLiteral("r"),
+        QStringLiteral("  failed   user "),
+        QStringLiteral("ok 1"),
+        QString::fromUtf8("ÄPFEL äpfel"),
+        QStringLiteral("missing")
+    };
+    for (const QString& filter : filters)
+    {
+        MatchList matches;
+        Document::filterText(*text, FilterQuery(filter), matches);
+        compareWithFullScan(lines, filter, matches);
+        if (QTest::currentTestFailed())
+        {
+            return;
+        }
+    }
+}
+
+void TestDocument::narrowingMatchesFullScan()
+{
+    // Results come from narrowing, not from the cache
+    Document::setResultCacheBudget(0);
+
+    QRandomGenerator random(1);
+    const QStringList lines = randomLines(random, 5000);
+    Document document(textBuffer(lines));
+
+    // Typed a character at a time. Appended characters and items narrow
+    // the previous result, a changed item starts over from all lines.
+    const QStringList typed = {
+        QStringLiteral("error disk 1"),
+        QStringLiteral("ok  user"),
+        QString::fromUtf8("äpfel net"),
+        QStringLiteral("ERROR fail")
+    };
+    for (const QString& filter : typed)
+    {
+        for (int length = 1; length <= filter.size(); ++length)
+        {
+            document.applyFilter(filter.left(length));
+            compareWithFullScan(lines, filter.left(length), *document.getMatches());
+            if (QTest::currentTestFailed())
+            {
+                return;
+            }
+        }
+    }
+}
+
+void TestDocument::indexedFilterMatchesFullScan()
+{
+    Document::setResultCacheBudget(0);
+    Document::setIndexingEnabled(true);
+
+    // Large enough to be indexed, which is done in background
+    QRandomGenerator random(6);
+    QStringList lines = randomLines(random, 250000);
+    std::shared_ptr<TextBuffer> text = textBuffer(lines);
+    QVERIFY(text->length() >= 4 * 1024 * 1024);
+    Document document(text);
+
+    auto isIndexed = [&document, &text]()
+    {
+        const std::shared_ptr<const TrigramIndex> index = document.getTrigramIndex();
+        return index != nullptr && index->lineCount() == text->lineCount();
+    };
+    QVERIFY(QTest::qWaitFor(isIndexed, 60000));
+
+    // Candidates of the index are verified, short items scan all lines
+    const QStringList filters = {
+        QStringLiteral("error disk"),
+        QStringLiteral("TIMEOUT user 12"),
+        QStringLiteral("ok"),
+        QStringLiteral("missing")
+    };
+    for (const QString& filter : filters)
+    {
+        document.applyFilter(filter);
+        compareWithFullScan(lines, filter, *document.getMatches());
+    }
+
+    // Index is updated with appended lines only
+    text = std::make_shared<TextBuffer>(*text);
+    text->appendToLastLine(u" network");
+    lines.last() += QStringLiteral(" network");
+    for (const QString& line : randomLines(random, 1000))
+    {
+        text->appendLine(line);
+        lines += line;
+    }
+    QVERIFY(document.appendText(text));
+    QVERIFY(QTest::qWaitFor(isIndexed, 60000));
+
+    document.applyFilter(QStringLiteral("failed network"));
+    compareWithFullScan(lines, QStringLiteral("failed network"), *document.getMatches());
+}
+
+void TestDocument::backspaceReusesHistory()
+{
+    // Results come from the history, not from the cache
+    Document::setResultCacheBudget(0);
+
+    QRandomGenerator random(2);
+    const QStringList lines = randomLines(random, 5000);
+    Document document(textBuffer(lines));
+
+    const QString filter = QStringLiteral("network fail");
+    std::vector<std::shared_ptr<const MatchList>> typed;
+    for (int length = 1; length <= filter.size(); ++length)
+    {
+        document.applyFilter(filter.left(length));
+        typed.push_back(document.getMatches());
+    }
+
+    // Every shorter filter gets back the result it had when it was typed
+    for (int length = filter.size() - 1; length >= 1; --length)
+    {
+        document.applyFilter(filter.left(length));
+        QVERIFY(document.getMatches() == typed[length - 1]);
+        compareWithFullScan(lines, filter.left(length), *document.getMatches());
+        if (QTest::currentTestFailed())
+        {
+            return;
+        }
+    }
+}
+
+void TestDocument::resultCacheDropsLeastRecentlyUsed()
+{
+    Document::setResultCacheBudget(size_t(64) * 1024 * 1024);
+
+    QRandomGenerator random(3);
+    const QStringList lines = randomLines(random, 5000);
+    Document document(textBuffer(lines));
+
+    // None of them narrows the one before
+    const QStringList filters = {
+        QStringLiteral("error"),
+        QStringLiteral("disk"),
+        QStringLiteral("login ok"),
+        QStringLiteral("user")
+    };
+    for (const QString& filter : filters)
+    {
+        document.applyFilter(filter);
+    }
+
+    // Every filter is found in the cache now, with the matches of a full scan
+    const Document::ResultCacheStats cached = Document::getResultCacheStats();
+    QCOMPARE(cached.resultCount, int(filters.size()));
+    for (const QString& filter : filters)
+    {
+        document.applyFilter(filter);
+        compareWithFullScan(lines, filter, *document.getMatches());
+    }
+    const Document::ResultCacheStats used = Document::getResultCacheStats();
+    QCOMPARE(used.hits, cached.hits + int(filters.size()));
+    QCOMPARE(used.misses, cached.misses);
+    QCOMPARE(used.memoryUsage, cached.memoryUsage);
+
+    // Over the budget, the filter used longest ago goes first
+    Document::setResultCacheBudget(used.memoryUsage - 1);
+    const Document::ResultCacheStats evicted = Document::getResultCacheStats();
+    QVERIFY(evicted.resultCount < used.resultCount);
+    QVERIFY(evicted.memoryUsage < used.memoryUsage);
+
+    document.applyFilter(filters.last());
+    QCOMPARE(Document::getResultCacheStats().hits, evicted.hits + 1);
+    document.applyFilter(filters.first());
+    QCOMPARE(Document::getResultCacheStats().misses, evicted.misses + 1);
+    compareWithFullScan(lines, filters.first(), *document.getMatches());
+
+    // No budget, no cache
+    Document::setResultCacheBudget(0);
+    QCOMPARE(Document::getResultCacheStats().resultCount, 0);
+    QCOMPARE(Document::getResultCacheStats().memoryUsage, size_t(0));
+}
+
+void TestDocument::appendedTextMatchesFullScan()
+{
+    Document::setResultCacheBudget(size_t(64) * 1024 * 1024);
+
+    QRandomGenerator random(4);
+    QStringList lines = randomLines(random, 3000);
+    std::shared_ptr<TextBuffer> text = textBuffer(lines);
+    Document document(text);
+
+    // Copy of the text with its last line continued and lines appended,
+    // as when a followed file grows, which keeps the revision
+    auto append = [&random, &lines, &text]()
+    {
+        text = std::make_shared<TextBuffer>(*text);
+        text->appendToLastLine(u" error failed");
+        lines.last() += QStringLiteral(" error failed");
+        for (const QString& line : randomLines(random, 500))
+        {
+            text->appendLine(line);
+            lines += line;
+        }
+        return text;
+    };
+
+    const QString filter = QStringLiteral("error fail");
+    document.applyFilter(filter);
+    const std::shared_ptr<const MatchList> shown = document.getMatches();
+    const int shownCount = shown->size();
+
+    // Only the new lines are filtered, into a new result
+    QVERIFY(document.appendText(append()));
+    compareWithFullScan(lines, filter, *document.getMatches());
+    QVERIFY(document.getMatches() != shown);
+    QCOMPARE(shown->size(), shownCount);
+
+    // Cached result of the text before the append is brought up to date
+    document.applyFilter(QStringLiteral("disk"));
+    QVERIFY(document.appendText(append()));
+    document.applyFilter(filter);
+    compareWithFullScan(lines, filter, *document.getMatches());
+
+    // Pass started before lines were appended
+    const QString passFilter = QStringLiteral("network");
+    const Document::FilterTask task = document.createFilterTask(passFilter);
+    QVERIFY(document.appendText(append()));
+    document.setFilterResult(passFilter, Document::runFilterTask(task));
+    compareWithFullScan(lines, passFilter, *document.getMatches());
+
+    // Text of another revision is not an append
+    QVERIFY(!document.appendText(textBuffer(lines)));
+}
+
+int runDocumentTests(int argc, char** argv)
+{
+    TestDocument test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "TestDocument.moc"
@@ -0,0 +1,176 @@
+#include "FileManager.h"
+#include "MappedFile.h"
+#include "TextCodec.h"
+
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QtTest>
+
+namespace
+{
+
+QStringList numberedLines(int count, int length)
+{
+    QStringList lines;
+    for (int i = 0; i < count; ++i)
+    {
+        QString line = QString::number(i) + u' ';
+        lines += line.leftJustified(length, u'x');
+    }
+    return lines;
+}
+
+}
+
+class TestFileManager : public QObject
+{
+    Q_OBJECT
+
+private slots:
+
+    void init();
+
+    void loadChunksOfWholeLines();
+    void loadChunksLongLine();
+    void loadChunksUtf16();
+    void loadEndings();
+    void mappedFileLines();
+    void mappedFileTruncated();
+
+private:
+
+    QString write(const QByteArray& bytes);
+
+    // Chunks of the file joined, checked to be split at line breaks
+    QString loadChunks(const QString& filename, TextCodec::Encoding& encoding);
+
+    QTemporaryDir mDir;
+    QString mFilename;
+};
+
+void TestFileManager::init()
+{
+    QVERIFY(mDir.isValid());
+    mFilename = mDir.filePath(QTest::currentTestFunction() + QStringLiteral(".txt"));
+}
+
+QString TestFileManager::write(const QByteArray& bytes)
+{
+    QFile file(mFilename);
+    if (!file.open(QIODevice::WriteOnly) || file.write(bytes) != bytes.size())
+    {
+        qWarning() << "Cannot write" << mFilename;
+    }
+    return mFilename;
+}
+
+QString TestFileManager::loadChunks(const QString& filename, TextCodec::Encoding& encoding)
+{
+    QString text;
+    int chunkCount = 0;
+    qint64 lastBytesRead = 0;
+    const bool isLoaded = FileManager::loadChunks(
+        filename,
+        [&](const QString& chunk, qint64 bytesRead, qint64 size)
+        {
+            // Every chunk but the first begins with the line break before it
+            QVERIFY(chunkCount == 0 || chunk.startsWith(u'\n'));
+            QVERIFY(bytesRead >= lastBytesRead && bytesRead <= size);
+            QCOMPARE(size, QFileInfo(filename).size());
+            lastBytesRead = bytesRead;
+            text += chunk;
+            ++chunkCount;
+        },
+        []() { return false; },
+        &encoding);
+    if (!isLoaded)
+    {
+        QTest::qFail("loadChunks failed", __FILE__, __LINE__);
+    }
+    return text;
+}
+
+void TestFileManager::loadChunksOfWholeLines()
+{
+    // Past the small first chunk and one of the large ones, with
+    // \r\n line breaks, which may be cut anywhere by a chunk end
+    const QStringList lines = numberedLines(120000, 40);
+    TextCodec::Encoding encoding = TextCodec::Encoding::Latin1;
+    const QString text = loadChunks(write(lines.join("\r\n").toUtf8()), encoding);
+    QCOMPARE(encoding, TextCodec::Encoding::Utf8);
+    QCOMPARE(text, lines.join(u'\n'));
+    QCOMPARE(FileManager::load(mFilename), text);
+}
+
+void TestFileManager::loadChunksLongLine()
+{
+    // First line longer than a chunk is read on until it ends
+    const QString longLine(200 * 1024, u'a');
+    const QString text = QString::fromUtf8("\xc3\xa4") + longLine + QStringLiteral("\nb\n");
+    TextCodec::Encoding encoding = TextCodec::Encoding::Latin1;
+    QCOMPARE(loadChunks(write(text.toUtf8()), encoding), text);
+}
+
+void TestFileManager::loadChunksUtf16()
+{
+    const QStringList lines = numberedLines(5000, 30);
+    const QString text = lines.join(u'\n') + QString::fromUtf8("\n\xc3\xa4");
+
+    QByteArray bytes = QByteArrayLiteral("\xff\xfe");
+    for (QChar c : text)
+    {
+        bytes.append(char(c.unicode() & 0xff));
+        bytes.append(char(c.unicode() >> 8));
+    }
+
+    TextCodec::Encoding encoding = TextCodec::Encoding::Utf8;
+    QCOMPARE(loadChunks(write(bytes), encoding), text);
+    QCOMPARE(encoding, TextCodec::Encoding::Utf16LE);
+}
+
+void TestFileManager::loadEndings()
+{
+    // Final line break starts an empty line, like a block of the
+    // editor, a \r at the very end is dropped with the byte order mark
+    TextCodec::Encoding encoding = TextCodec::Encoding::Utf8;
+    QCOMPARE(loadChunks(write("a\r\nb\r\n"), encoding), QStringLiteral("a\nb\n"));
+    QCOMPARE(loadChunks(write("\xef\xbb\xbf" "a\nb\r"), encoding), QStringLiteral("a\nb"));
+    QCOMPARE(loadChunks(write(""), encoding), QString());
+    QCOMPARE(loadChunks(write("caf\xe9!"), encoding), QString::fromUtf8("caf\xc3\xa9!"));
+    QCOMPARE(encoding, TextCodec::Encoding::Latin1);
+}
+
+void TestFileManager::mappedFileLines()
+{
+    const MappedFile file(write("\xef\xbb\xbf" "one\r\ntwo\n\nfour"));
+    QVERIFY(file.isOpen());
+    QVERIFY(!file.isTruncated());
+    QCOMPARE(file.lineCount(), 4);
+    QVERIFY(file.lineBytes(0) == QByteArrayView("one"));
+    QVERIFY(file.lineBytes(2).isEmpty());
+    QCOMPARE(file.text(0, 2), QStringLiteral("one\ntwo"));
+    QCOMPARE(file.text(1, 3), QStringLiteral("two\n\nfour"));
+}
+
+void TestFileManager::mappedFileTruncated()
+{
+#ifdef Q_OS_WIN
+    QSKIP("Mapped files cannot be truncated on Windows");
+#endif
+    const MappedFile file(write(QByteArray(64 * 1024, 'a') + "\nb\n"));
+    QVERIFY(file.isOpen());
+    QVERIFY(!file.isTruncated());
+
+    // As logrotate copytruncate does, the mapped bytes are not touched
+    QFile other(mFilename);
+    QVERIFY(other.resize(0));
+    QVERIFY(file.isTruncated());
+}
+
+int runFileManagerTests(int argc, char** argv)
+{
+    TestFileManager test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "TestFileManager.moc"
@@ -0,0 +1,148 @@
+#include "Document.h"
+#include "MatchList.h"
+#include "TextBuffer.h"
+
+#include <QtTest>
+
+#include <memory>
+
+namespace
+{
+
+// Matches of lines with one area each
+MatchList matchList(std::initializer_list<int> lines)
+{
+    MatchList matches;
+    for (int lineNum : lines)
+    {
+        std::pmr::vector<HighlightArea> areas;
+        areas.emplace_back(0, 1);
+        matches.append(lineNum, areas);
+    }
+    return matches;
+}
+
+}
+
+class TestMatchList : public QObject
+{
+    Q_OBJECT
+
+private slots:
+
+    void nextAndPreviousIndex();
+    void truncateAndAppend();
+    void appendFirstMatches();
+    void highlightWrapsAround();
+    void highlightWithoutMatches();
+};
+
+void TestMatchList::nextAndPreviousIndex()
+{
+    const MatchList matches = matchList({2, 5, 9});
+
+    QCOMPARE(matches.indexOf(5), 1);
+    QCOMPARE(matches.indexOf(4), -1);
+
+    QCOMPARE(matches.nextIndex(-1), 0);
+    QCOMPARE(matches.nextIndex(2), 1);
+    QCOMPARE(matches.nextIndex(6), 2);
+    QCOMPARE(matches.nextIndex(9), matches.size());
+
+    QCOMPARE(matches.previousIndex(2), -1);
+    QCOMPARE(matches.previousIndex(5), 0);
+    QCOMPARE(matches.previousIndex(10), 2);
+}
+
+void TestMatchList::truncateAndAppend()
+{
+    MatchList matches = matchList({2, 5, 9});
+    matches.truncate(matches.nextIndex(4));
+    QCOMPARE(matches.size(), 1);
+    QCOMPARE(matches.areaCount(), 1);
+
+    matches.append(matchList({7, 8}));
+    QCOMPARE(matches.size(), 3);
+    QCOMPARE(matches.lineAt(2), 8);
+    QCOMPARE(int(matches.areaEnd(2) - matches.areaBegin(2)), 1);
+}
+
+void TestMatchList::appendFirstMatches()
+{
+    // Lines with two areas, so area offsets are shifted by the
+    // areas already in the list
+    MatchList other;
+    for (int lineNum : {4, 6, 8})
+    {
+        std::pmr::vector<HighlightArea> areas;
+        areas.emplace_back(lineNum, lineNum + 1);
+        areas.emplace_back(lineNum + 2, lineNum + 3);
+        other.append(lineNum, areas);
+    }
+
+    MatchList matches = matchList({1});
+    matches.reserve(3, 5);
+    const size_t memoryUsage = matches.memoryUsage();
+    matches.append(other, 2);
+
+    // Reserved room is enough, nothing was allocated
+    QCOMPARE(matches.memoryUsage(), memoryUsage);
+    QCOMPARE(matches.size(), 3);
+    QCOMPARE(matches.areaCount(), 5);
+    QCOMPARE(matches.lineAt(2), 6);
+    QCOMPARE(int(matches.areaEnd(2) - matches.areaBegin(2)), 2);
+    QCOMPARE(matches.areaBegin(2)->begin, 6);
+    QCOMPARE((matches.areaBegin(2) + 1)->begin, 8);
+
+    // No matches of other
+    matches.append(other, 0);
+    QCOMPARE(matches.size(), 3);
+    QCOMPARE(matches.areaCount(), 5);
+}
+
+void TestMatchList::highlightWrapsAround()
+{
+    auto text = std::make_shared<TextBuffer>();
+    for (const char* line : {"apple", "pear", "Apple pie", "plum", "green apple"})
+    {
+        text->appendLine(QString::fromLatin1(line));
+    }
+
+    Document document(text);
+    document.applyFilter(QStringLiteral("apple"));
+    QCOMPARE(document.getFilteredLineCount(), 3);
+
+    QCOMPARE(document.highlightNextLine(), 0);
+    QCOMPARE(document.highlightNextLine(), 2);
+    QCOMPARE(document.highlightNextLine(), 4);
+    QCOMPARE(document.highlightNextLine(), 0);
+
+    QCOMPARE(document.highlightPrevLine(), 4);
+    QCOMPARE(document.highlightPrevLine(), 2);
+
+    // From a line between matches
+    document.setCurrentHighlightedLineNum(3);
+    QCOMPARE(document.highlightNextLine(), 4);
+    document.setCurrentHighlightedLineNum(1);
+    QCOMPARE(document.highlightPrevLine(), 0);
+}
+
+void TestMatchList::highlightWithoutMatches()
+{
+    auto text = std::make_shared<TextBuffer>();
+    text->appendLine(QStringLiteral("apple"));
+
+    Document document(text);
+    document.applyFilter(QStringLiteral("kiwi"));
+    QCOMPARE(document.getFilteredLineCount(), 0);
+    QCOMPARE(document.highlightNextLine(), -1);
+    QCOMPARE(document.highlightPrevLine(), -1);
+}
+
+int runMatchListTests(int argc, char** argv)
+{
+    TestMatchList test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "TestMatchList.moc"
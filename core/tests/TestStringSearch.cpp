@@ -0,0 +1,177 @@
+#include "StringSearch.h"
+
+#include <QRandomGenerator>
+#include <QtTest>
+
+namespace
+{
+
+// Plain loop over every position, what the SIMD kernels
+// and Horspool skips have to agree with
+qsizetype referenceIndexOf(QStringView haystack, QStringView needle, qsizetype from)
+{
+    for (qsizetype i = from; i + needle.size() <= haystack.size(); ++i)
+    {
+        qsizetype j = 0;
+        while (j < needle.size()
+               && QChar::toCaseFolded(char32_t(haystack[i + j].unicode()))
+                  == QChar::toCaseFolded(char32_t(needle[j].unicode())))
+        {
+            ++j;
+        }
+        if (j == needle.size())
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+}
+
+class TestStringSearch : public QObject
+{
+    Q_OBJECT
+
+private slots:
+
+    void initTestCase_data();
+    void init();
+    void cleanupTestCase();
+
+    void isAscii();
+    void indexOfAtBlockBoundaries();
+    void indexOfRandomText();
+    void indexOfNonAscii();
+};
+
+void TestStringSearch::initTestCase_data()
+{
+    // Every test runs with each kernel this CPU has
+    QTest::addColumn<bool>("isAvx2Enabled");
+    QTest::newRow("default") << true;
+    QTest::newRow("without AVX2") << false;
+}
+
+void TestStringSearch::init()
+{
+    QFETCH_GLOBAL(bool, isAvx2Enabled);
+    StringSearch::setAvx2Enabled(isAvx2Enabled);
+}
+
+void TestStringSearch::cleanupTestCase()
+{
+    StringSearch::setAvx2Enabled(true);
+}
+
+void TestStringSearch::isAscii()
+{
+    // Non-ASCII character at every position of a few register widths
+    for (int length = 0; length <= 72; ++length)
+    {
+        QString text(length, u'a');
+        QVERIFY(StringSearch::isAscii(text));
+
+        for (int position = 0; position < length; ++position)
+        {
+            text[position] = QChar(0x80);
+            QVERIFY(!StringSearch::isAscii(text));
+            text[position] = QChar(0x7f);
+            QVERIFY(StringSearch::isAscii(text));
+            text[position] = u'a';
+        }
+    }
+}
+
+void TestStringSearch::indexOfAtBlockBoundaries()
+{
+    // Lengths around the 8 and 16 characters of SSE2 and AVX2 registers,
+    // short needles go to the SIMD kernel, long ones to Horspool
+    const QString letters = QStringLiteral("abcdefghij");
+    for (int needleLength : {1, 2, 3, 4, 7, 8, 9, 15, 16, 17, 31, 32, 33})
+    {
+        QString needle;
+        while (needle.size() < needleLength)
+        {
+            needle += letters.at(needle.size() % letters.size());
+        }
+        const StringSearch::AsciiNeedle asciiNeedle(needle);
+
+        for (int length = needleLength; length <= 80; ++length)
+        {
+            for (int position = 0; position + needleLength <= length; ++position)
+            {
+                QString haystack(length, u'x');
+                haystack.replace(position, needleLength, needle.toUpper());
+
+                for (qsizetype from : {qsizetype(0), qsizetype(position), qsizetype(position + 1)})
+                {
+                    const qsizetype expected = referenceIndexOf(haystack, needle, from);
+                    QCOMPARE(StringSearch::indexOf(haystack, needle, from, true), expected);
+                    QCOMPARE(asciiNeedle.indexIn(haystack, from), expected);
+                }
+            }
+        }
+    }
+}
+
+void TestStringSearch::indexOfRandomText()
+{
+    // Few letters, so there are many partial matches
+    const QString letters = QStringLiteral("aAbB ");
+    QRandomGenerator random(42);
+
+    auto randomText = [&](int length)
+    {
+        QString text;
+        for (int i = 0; i < length; ++i)
+        {
+            text += letters.at(random.bounded(letters.size()));
+        }
+        return text;
+    };
+
+    for (int i = 0; i < 2000; ++i)
+    {
+        const QString haystack = randomText(random.bounded(100));
+        const QString needle = randomText(1 + random.bounded(i % 2 == 0 ? 8 : 40));
+        const StringSearch::AsciiNeedle asciiNeedle(needle);
+
+        for (qsizetype from = 0; from <= haystack.size(); ++from)
+        {
+            const qsizetype expected = referenceIndexOf(haystack, needle, from);
+            QCOMPARE(StringSearch::indexOf(haystack, needle, from, true), expected);
+            QCOMPARE(asciiNeedle.indexIn(haystack, from), expected);
+        }
+    }
+}
+
+void TestStringSearch::indexOfNonAscii()
+{
+    const QString haystack = QString::fromUtf8("Straße ÄPFEL und äpfel, Ωmega und ωMEGA");
+    const QStringList needles = {
+        QString::fromUtf8("äpfel"),
+        QString::fromUtf8("ÄPFEL"),
+        QString::fromUtf8("ωmega"),
+        QString::fromUtf8("ße"),
+        QStringLiteral("und")
+    };
+
+    for (const QString& needle : needles)
+    {
+        for (qsizetype from = 0; from <= haystack.size(); ++from)
+        {
+            QCOMPARE(
+                StringSearch::indexOf(haystack, needle, from, false),
+                haystack.indexOf(needle, from, Qt::CaseInsensitive));
+        }
+    }
+}
+
+int runStringSearchTests(int argc, char** argv)
+{
+    TestStringSearch test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "TestStringSearch.moc"
@@ -0,0 +1,261 @@
+#include "TextCodec.h"
+
+#include <QRandomGenerator>
+#include <QtTest>
+
+namespace
+{
+
+// Bytes of a literal, embedded zeros included
+template<size_t N>
+QByteArray bytes(const char (&text)[N])
+{
+    return QByteArray(text, N - 1);
+}
+
+QString decodeUtf8(const QByteArray& bytes)
+{
+    return TextCodec::decode(bytes, TextCodec::Encoding::Utf8);
+}
+
+QString replacements(int count)
+{
+    return QString(count, QChar(0xfffd));
+}
+
+}
+
+class TestTextCodec : public QObject
+{
+    Q_OBJECT
+
+private slots:
+
+    void decodeValidUtf8();
+    void decodeInvalidUtf8();
+    void decodeOverlongUtf8();
+    void decodeRandomUtf8();
+    void decodeSplitCrLf();
+    void decodeUtf16();
+    void completeLengthUtf8();
+    void completeLengthUtf16();
+    void lastLineEnd();
+    void detectByteOrderMark();
+    void encodeUtf8();
+};
+
+void TestTextCodec::decodeValidUtf8()
+{
+    QCOMPARE(decodeUtf8(bytes("plain")), QStringLiteral("plain"));
+    QCOMPARE(decodeUtf8(bytes("\xc3\xa4")), QString(QChar(0xe4)));
+    QCOMPARE(decodeUtf8(bytes("\xe2\x82\xac")), QString(QChar(0x20ac)));
+    QCOMPARE(decodeUtf8(bytes("\xf0\x9f\x98\x80")), QString::fromUcs4(U"\U0001f600", 1));
+
+    // Multibyte character right after a whole SIMD block of ASCII
+    for (int prefix = 0; prefix <= 40; ++prefix)
+    {
+        const QByteArray ascii(prefix, 'a');
+        QCOMPARE(
+            decodeUtf8(ascii + bytes("\xe2\x82\xac") + ascii),
+            QString::fromLatin1(ascii) + QChar(0x20ac) + QString::fromLatin1(ascii));
+    }
+}
+
+void TestTextCodec::decodeInvalidUtf8()
+{
+    // Every byte which does not start a valid sequence is one U+FFFD
+    QCOMPARE(decodeUtf8(bytes("\x80")), replacements(1));
+    QCOMPARE(decodeUtf8(bytes("a\xff" "b")), QStringLiteral("a") + replacements(1) + QStringLiteral("b"));
+    QCOMPARE(decodeUtf8(bytes("\xed\xa0\x80")), replacements(3));
+    QCOMPARE(decodeUtf8(bytes("\xf4\x90\x80\x80")), replacements(4));
+
+    // Sequence cut by the end of input
+    QCOMPARE(decodeUtf8(bytes("a\xe2\x82")), QStringLiteral("a") + replacements(2));
+
+    // Invalid byte in the middle of an ASCII run
+    const QByteArray ascii(20, 'a');
+    QCOMPARE(
+        decodeUtf8(ascii + bytes("\xff") + ascii),
+        QString::fromLatin1(ascii) + replacements(1) + QString::fromLatin1(ascii));
+}
+
+void TestTextCodec::decodeOverlongUtf8()
+{
+    // Slash, encoded in 2, 3 and 4 bytes
+    QCOMPARE(decodeUtf8(bytes("\xc0\xaf")), replacements(2));
+    QCOMPARE(decodeUtf8(bytes("\xe0\x80\xaf")), replacements(3));
+    QCOMPARE(decodeUtf8(bytes("\xf0\x80\x80\xaf")), replacements(4));
+
+    // Shortest forms are fine
+    QCOMPARE(decodeUtf8(bytes("\xc2\x80")), QString(QChar(0x80)));
+    QCOMPARE(decodeUtf8(bytes("\xe0\xa0\x80")), QString(QChar(0x800)));
+}
+
+void TestTextCodec::decodeRandomUtf8()
+{
+    // ASCII runs of any length between characters of every UTF-8
+    // length and line breaks, so they meet the SIMD blocks anywhere
+    const QStringList pieces = {
+        QStringLiteral("a"),
+        QStringLiteral("plain text "),
+        QStringLiteral("\r\n"),
+        QStringLiteral("\r"),
+        QString(QChar(0xe4)),
+        QString(QChar(0x20ac)),
+        QString::fromUcs4(U"\U0001f600", 1)
+    };
+
+    QRandomGenerator random(19);
+    for (int i = 0; i < 1000; ++i)
+    {
+        QString text;
+        const int count = random.bounded(40);
+        for (int n = 0; n < count; ++n)
+        {
+            text += pieces.at(random.bounded(pieces.size()));
+        }
+
+        QString expected = text;
+        expected.replace(QStringLiteral("\r\n"), QStringLiteral("\n"));
+        QCOMPARE(decodeUtf8(text.toUtf8()), expected);
+    }
+}
+
+void TestTextCodec::decodeSplitCrLf()
+{
+    QCOMPARE(decodeUtf8(bytes("a\r\nb")), QStringLiteral("a\nb"));
+    QCOMPARE(decodeUtf8(bytes("\r\r\n")), QStringLiteral("\r\n"));
+
+    // \n of the pair comes with the next bytes, the \r stays
+    QCOMPARE(decodeUtf8(bytes("a\r")), QStringLiteral("a\r"));
+    QCOMPARE(decodeUtf8(bytes("\nb")), QStringLiteral("\nb"));
+
+    // Pair across the end of a SIMD block, in every encoding
+    // which decodes bytes a block at a time
+    for (int prefix = 0; prefix <= 40; ++prefix)
+    {
+        const QByteArray ascii(prefix, 'a');
+        const QString expected = QString::fromLatin1(ascii) + QStringLiteral("\nb");
+        QCOMPARE(decodeUtf8(ascii + bytes("\r\nb")), expected);
+        QCOMPARE(TextCodec::decode(ascii + bytes("\r\nb"), TextCodec::Encoding::Latin1), expected);
+    }
+}
+
+void TestTextCodec::decodeUtf16()
+{
+    QCOMPARE(
+        TextCodec::decode(bytes("h\0i\0\r\0\n\0"), TextCodec::Encoding::Utf16LE),
+        QStringLiteral("hi\n"));
+    QCOMPARE(
+        TextCodec::decode(bytes("\0h\0i\0\r"), TextCodec::Encoding::Utf16BE),
+        QStringLiteral("hi\r"));
+
+    // Odd last byte is not a character
+    QCOMPARE(
+        TextCodec::decode(bytes("h\0i"), TextCodec::Encoding::Utf16LE),
+        QStringLiteral("h"));
+}
+
+void TestTextCodec::completeLengthUtf8()
+{
+    const QByteArray text = bytes("a\xc3\xa4\xe2\x82\xac\xf0\x9f\x98\x80" "b");
+
+    // Decoding the complete part and carrying the rest to the next
+    // bytes gives the same text at every split
+    for (qsizetype split = 0; split <= text.size(); ++split)
+    {
+        const QByteArray first = text.left(split);
+        const qsizetype length = TextCodec::completeLength(first, TextCodec::Encoding::Utf8);
+        QVERIFY(length <= split);
+        QCOMPARE(
+            decodeUtf8(first.left(length)) + decodeUtf8(first.mid(length) + text.mid(split)),
+            decodeUtf8(text));
+    }
+
+    // Invalid bytes are not carried, waiting would not make them valid
+    QCOMPARE(TextCodec::completeLength(bytes("a\xff"), TextCodec::Encoding::Utf8), qsizetype(2));
+    QCOMPARE(TextCodec::completeLength(bytes("a\xe2\x82"), TextCodec::Encoding::Utf8), qsizetype(1));
+}
+
+void TestTextCodec::completeLengthUtf16()
+{
+    // h, U+1F600 as a surrogate pair, i
+    const QByteArray text = bytes("h\0\x3d\xd8\x00\xde" "i\0");
+    const auto encoding = TextCodec::Encoding::Utf16LE;
+
+    for (qsizetype split = 0; split <= text.size(); ++split)
+    {
+        const QByteArray first = text.left(split);
+        const qsizetype length = TextCodec::completeLength(first, encoding);
+        QVERIFY(length <= split);
+        QCOMPARE(
+            TextCodec::decode(first.left(length), encoding)
+                + TextCodec::decode(first.mid(length) + text.mid(split), encoding),
+            TextCodec::decode(text, encoding));
+    }
+
+    QCOMPARE(TextCodec::completeLength(bytes("h\0\x3d"), encoding), qsizetype(2));
+    QCOMPARE(TextCodec::completeLength(bytes("h\0\x3d\xd8"), encoding), qsizetype(2));
+    QCOMPARE(TextCodec::completeLength(bytes("\0h\xd8\x3d"), TextCodec::Encoding::Utf16BE), qsizetype(2));
+}
+
+void TestTextCodec::lastLineEnd()
+{
+    QCOMPARE(TextCodec::lastLineEnd(bytes("a\nb\r\nc"), TextCodec::Encoding::Utf8), qsizetype(5));
+    QCOMPARE(TextCodec::lastLineEnd(bytes("a\n"), TextCodec::Encoding::Latin1), qsizetype(2));
+    QCOMPARE(TextCodec::lastLineEnd(bytes("abc"), TextCodec::Encoding::Utf8), qsizetype(0));
+    QCOMPARE(TextCodec::lastLineEnd(QByteArray(), TextCodec::Encoding::Utf8), qsizetype(0));
+
+    // Only a whole \n character of UTF-16 ends a line, not a 0x0a byte
+    // of another one, and not an odd byte at the end
+    QCOMPARE(TextCodec::lastLineEnd(bytes("\n\0\0\n" "a"), TextCodec::Encoding::Utf16LE), qsizetype(2));
+    QCOMPARE(TextCodec::lastLineEnd(bytes("\0\n\n\0"), TextCodec::Encoding::Utf16BE), qsizetype(2));
+    QCOMPARE(TextCodec::lastLineEnd(bytes("\x0a\x01"), TextCodec::Encoding::Utf16LE), qsizetype(0));
+}
+
+void TestTextCodec::detectByteOrderMark()
+{
+    int bomLength = -1;
+    QCOMPARE(TextCodec::detect(bytes("\xef\xbb\xbf" "abc"), bomLength), TextCodec::Encoding::Utf8);
+    QCOMPARE(bomLength, 3);
+    QCOMPARE(TextCodec::detect(bytes("\xff\xfe" "a\0"), bomLength), TextCodec::Encoding::Utf16LE);
+    QCOMPARE(bomLength, 2);
+    QCOMPARE(TextCodec::detect(bytes("\xfe\xff\0" "a"), bomLength), TextCodec::Encoding::Utf16BE);
+    QCOMPARE(bomLength, 2);
+
+    // Without one, the bytes decide
+    QCOMPARE(TextCodec::detect(bytes("plain"), bomLength), TextCodec::Encoding::Utf8);
+    QCOMPARE(bomLength, 0);
+    QCOMPARE(TextCodec::detect(bytes("caf\xc3\xa9"), bomLength), TextCodec::Encoding::Utf8);
+    QCOMPARE(TextCodec::detect(bytes("caf\xe9"), bomLength), TextCodec::Encoding::Latin1);
+    QCOMPARE(bomLength, 0);
+
+    // Head may end in the middle of a character
+    QCOMPARE(TextCodec::detect(bytes("caf\xc3"), bomLength), TextCodec::Encoding::Utf8);
+
+    // Text after the mark, the mark itself is not decoded
+    const QByteArray bigEndian = bytes("\xfe\xff\0h\0i");
+    const TextCodec::Encoding encoding = TextCodec::detect(bigEndian, bomLength);
+    QCOMPARE(TextCodec::decode(bigEndian.mid(bomLength), encoding), QStringLiteral("hi"));
+}
+
+void TestTextCodec::encodeUtf8()
+{
+    QCOMPARE(TextCodec::encodeUtf8(u"plain"), bytes("plain"));
+    QCOMPARE(TextCodec::encodeUtf8(QString(QChar(0x20ac))), bytes("\xe2\x82\xac"));
+    QCOMPARE(
+        TextCodec::encodeUtf8(QString::fromUcs4(U"\U0001f600", 1)),
+        bytes("\xf0\x9f\x98\x80"));
+
+    QString unpaired = QStringLiteral("ab");
+    unpaired.insert(1, QChar(0xd800));
+    QCOMPARE(TextCodec::encodeUtf8(unpaired), bytes("a\xef\xbf\xbd" "b"));
+}
+
+int runTextCodecTests(int argc, char** argv)
+{
+    TestTextCodec test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "TestTextCodec.moc"
@@ -0,0 +1,175 @@
+#include "FilterQuery.h"
+#include "TextBuffer.h"
+#include "TrigramIndex.h"
+
+#include <QRandomGenerator>
+#include <QtTest>
+
+#include <algorithm>
+
+namespace
+{
+
+const QStringList kFilters = {
+    QStringLiteral("error"),
+    QStringLiteral("disk fail"),
+    QStringLiteral("net"),
+    QStringLiteral("timeout user"),
+    QStringLiteral("LOGIN ok"),
+    QStringLiteral("missing"),
+
+    // Too short for the index
+    QStringLiteral("ok")
+};
+
+QStringList randomLines(QRandomGenerator& random, int count)
+{
+    const QStringList words = {
+        "error", "warning", "disk", "network", "timeout",
+        "user", "login", "failed", "ok", "ERROR"
+    };
+
+    QStringList lines;
+    for (int i = 0; i < count; ++i)
+    {
+        QStringList line;
+        const int wordCount = 1 + random.bounded(6);
+        for (int n = 0; n < wordCount; ++n)
+        {
+            line += words.at(random.bounded(words.size()));
+        }
+        line += QString::number(random.bounded(1000));
+        lines += line.join(u' ');
+    }
+    return lines;
+}
+
+TextBuffer textBuffer(const QStringList& lines)
+{
+    TextBuffer text;
+    for (const QString& line : lines)
+    {
+        text.appendLine(line);
+    }
+    return text;
+}
+
+}
+
+class TestTrigramIndex : public QObject
+{
+    Q_OBJECT
+
+private slots:
+
+    void appendedLines();
+    void editedLines();
+
+private:
+
+    // Incremental index has to find the same candidates as one built
+    // from scratch, and they have to include every matching line
+    static void compare(const TrigramIndex& updated, const TextBuffer& text);
+};
+
+void TestTrigramIndex::compare(const TrigramIndex& updated, const TextBuffer& text)
+{
+    const TrigramIndex rebuilt(text);
+    QCOMPARE(updated.lineCount(), text.lineCount());
+    QCOMPARE(rebuilt.lineCount(), text.lineCount());
+
+    for (const QString& filter : kFilters)
+    {
+        const FilterQuery query(filter);
+
+        std::vector<int> updatedLines;
+        std::vector<int> rebuiltLines;
+        const bool isUpdatedUsed = updated.findCandidates(query, updatedLines);
+        QCOMPARE(isUpdatedUsed, rebuilt.findCandidates(query, rebuiltLines));
+        if (!isUpdatedUsed)
+        {
+            continue;
+        }
+        QVERIFY(updatedLines == rebuiltLines);
+
+        for (int lineNum = 0; lineNum < text.lineCount(); ++lineNum)
+        {
+            const QStringView line = text.foldedLine(lineNum);
+            const bool hasAllItems = std::all_of(
+                query.items().begin(),
+                query.items().end(),
+                [line](const QString& item)
+                {
+                    return line.contains(TextBuffer::foldCase(item));
+                });
+            if (hasAllItems)
+            {
+                QVERIFY(std::binary_search(updatedLines.begin(), updatedLines.end(), lineNum));
+            }
+        }
+    }
+}
+
+void TestTrigramIndex::appendedLines()
+{
+    QRandomGenerator random(7);
+    const QStringList lines = randomLines(random, 3000);
+    const TextBuffer text = textBuffer(lines);
+    const TrigramIndex index(text);
+
+    // Last line is continued, as when a followed file grows
+    TextBuffer appended = text;
+    appended.appendToLastLine(QStringLiteral(" network failed"));
+    for (const QString& line : randomLines(random, 500))
+    {
+        appended.appendLine(line);
+    }
+
+    compare(TrigramIndex(index, appended, text.lineCount() - 1), appended);
+}
+
+void TestTrigramIndex::editedLines()
+{
+    QRandomGenerator random(11);
+    QStringList lines = randomLines(random, 3000);
+    const TextBuffer text = textBuffer(lines);
+    const TrigramIndex index(text);
+
+    // Replaced, removed and inserted lines, in the buffer and in the list
+    TextBuffer edited = text;
+    const QStringList replacement = randomLines(random, 3);
+    edited.replaceLines(1000, 5, replacement);
+    lines.erase(lines.begin() + 1000, lines.begin() + 1005);
+    for (int i = 0; i < replacement.size(); ++i)
+    {
+        lines.insert(1000 + i, replacement[i]);
+    }
+
+    edited.replaceLines(10, 5, {});
+    lines.erase(lines.begin() + 10, lines.begin() + 15);
+
+    const QStringList inserted = randomLines(random, 2);
+    edited.replaceLines(edited.lineCount(), 0, inserted);
+    lines += inserted;
+
+    // Edited buffer holds the same text as one built from the lines
+    const TextBuffer rebuilt = textBuffer(lines);
+    QCOMPARE(edited.lineCount(), rebuilt.lineCount());
+    QCOMPARE(edited.length(), rebuilt.length());
+    QVERIFY(edited.revision() != text.revision());
+    for (int lineNum = 0; lineNum < rebuilt.lineCount(); ++lineNum)
+    {
+        QCOMPARE(edited.foldedLine(lineNum), rebuilt.foldedLine(lineNum));
+        QCOMPARE(edited.isFoldedLineAscii(lineNum), rebuilt.isFoldedLineAscii(lineNum));
+    }
+
+    compare(TrigramIndex(index, edited), edited);
+}
+
+int runTrigramIndexTests(int argc, char** argv)
+{
+    TestTrigramIndex test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "TestTrigramIndex.moc"
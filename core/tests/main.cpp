@@ -0,0 +1,24 @@
+#include <QCoreApplication>
+
+int runDocumentTests(int argc, char** argv);
+int runFileManagerTests(int argc, char** argv);
+int runMatchListTests(int argc, char** argv);
+int runStringSearchTests(int argc, char** argv);
+int runTextCodecTests(int argc, char** argv);
+int runTrigramIndexTests(int argc, char** argv);
+
+// Runs the tests of every class, fails if any of them failed.
+// Filter passes of Document need the application for their threads.
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+
+    int status = 0;
+    status |= runDocumentTests(argc, argv);
+    status |= runFileManagerTests(argc, argv);
+    status |= runMatchListTests(argc, argv);
+    status |= runStringSearchTests(argc, argv);
+    status |= runTextCodecTests(argc, argv);
+    status |= runTrigramIndexTests(argc, argv);
+    return status;
+}
@@ -0,0 +1,22 @@
+# Unit tests of the filter engine, run with make check
+# or textfilter-core-tests from the build directory.
+
+QT = core testlib
+
+TARGET = textfilter-core-tests
+TEMPLATE = app
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+include(../core.pri)
+
+SOURCES += \
+    TestDocument.cpp \
+    TestFileManager.cpp \
+    TestMatchList.cpp \
+    TestStringSearch.cpp \
+    TestTextCodec.cpp \
+    TestTrigramIndex.cpp \
+    main.cpp